@@ -0,0 +1,7 @@
+; Ackermann's function, mixing tail and non-tail calls through cond.
+; ops: 2785999 calls of ack
+(define (ack m n)
+  (cond ((= m 0) (+ n 1))
+        ((= n 0) (ack (- m 1) 1))
+        (else (ack (- m 1) (ack m (- n 1))))))
+(displayln (ack 3 8))
@@ -0,0 +1,161 @@
+// Runs every workload in the benchmarks directory several times in a fresh
+// interpreter process and prints one JSON object per workload: the median
+// wall time, the work done per second by the "; ops: N" header of the file,
+// and the largest resident set size any run reached.
+//
+// Usage: mini_lisp_bench [--runs=N] [--bin=PATH] [--dir=PATH]
+//                        [interpreter options...] [workload...]
+// Options starting with -- that are not the runner's own are passed to the
+// interpreter, so --engine=vm or --jit measure the other engines.
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct Run {
+    double seconds;
+    long peakKb;
+    bool ok;
+};
+
+struct Workload {
+    std::string name;
+    std::string path;
+    long ops;
+};
+
+// The count after "; ops:" in the leading comment, or 0 when there is none.
+long readOps(const std::string& path){
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line) && line.starts_with(";")) {
+        if (line.starts_with("; ops:"))
+            return std::atol(line.c_str() + 6);
+    }
+    return 0;
+}
+
+// Runs the interpreter on the workload with its output discarded. The run
+// fails when the process does not exit with 0 or prints an error.
+Run runOnce(const std::string& bin, const std::vector<std::string>& options, const std::string& path){
+    int output[2];
+    if (pipe(output) != 0)
+        return {0, 0, false};
+    auto start = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child == 0) {
+        dup2(output[1], STDOUT_FILENO);
+        dup2(output[1], STDERR_FILENO);
+        close(output[0]);
+        close(output[1]);
+        std::vector<char*> argv{const_cast<char*>(bin.c_str())};
+        for (const auto& option : options)
+            argv.push_back(const_cast<char*>(option.c_str()));
+        argv.push_back(const_cast<char*>(path.c_str()));
+        argv.push_back(nullptr);
+        execv(bin.c_str(), argv.data());
+        _exit(127);
+    }
+    close(output[1]);
+    std::string text;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(output[0], buffer, sizeof buffer)) > 0)
+        text.append(buffer, n);
+    close(output[0]);
+    int status = 0;
+    rusage usage {};
+    wait4(child, &status, 0, &usage);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    bool ok = child > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0
+              && text.find("Error") == std::string::npos;
+    return {elapsed.count(), usage.ru_maxrss, ok};
+}
+
+std::string escape(const std::string& text){
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char* argv[]){
+    int runs = 5;
+    std::string bin = MINI_LISP_BIN;
+    std::string dir = BENCH_DIR;
+    std::vector<std::string> options;
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.starts_with("--runs="))
+            runs = std::max(1, std::atoi(arg.c_str() + 7));
+        else if (arg.starts_with("--bin="))
+            bin = arg.substr(6);
+        else if (arg.starts_with("--dir="))
+            dir = arg.substr(6);
+        else if (arg.starts_with("--"))
+            options.push_back(arg);
+        else
+            selected.push_back(arg);
+    }
+
+    std::vector<Workload> workloads;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() != ".lisp")
+            continue;
+        auto name = entry.path().stem().string();
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), name) == selected.end())
+            continue;
+        workloads.push_back({name, entry.path().string(), readOps(entry.path().string())});
+    }
+    std::sort(workloads.begin(), workloads.end(), [](const auto& x, const auto& y){
+        return x.name < y.name;
+    });
+
+    std::string engine;
+    for (const auto& option : options)
+        engine += (engine.empty() ? "" : " ") + option;
+    bool failed = false;
+    for (const auto& workload : workloads) {
+        std::vector<double> times;
+        long peakKb = 0;
+        bool ok = true;
+        for (int i = 0; i < runs && ok; i++) {
+            auto run = runOnce(bin, options, workload.path);
+            ok = run.ok;
+            times.push_back(run.seconds);
+            peakKb = std::max(peakKb, run.peakKb);
+        }
+        std::sort(times.begin(), times.end());
+        double median = times.size() % 2 ? times[times.size() / 2]
+                                         : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(6)
+             << "{\"benchmark\": \"" << escape(workload.name) << "\", \"options\": \"" << escape(engine)
+             << "\", \"runs\": " << times.size() << ", \"ok\": " << (ok ? "true" : "false")
+             << ", \"median_seconds\": " << median << ", \"ops\": " << workload.ops
+             << ", \"ops_per_second\": " << std::setprecision(0) << (median > 0 ? workload.ops / median : 0)
+             << ", \"peak_rss_kb\": " << peakKb << "}";
+        std::cout << line.str() << std::endl;
+        failed = failed || !ok;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+; Call overhead: every iteration makes three procedure calls, each of which
+; opens one or two new frames through lambda, let and let*.
+; ops: 600000 procedure calls
+; Run with: time ./bin/mini_lisp benchmarks/call_overhead.lisp
+(define (id x) x)
+(define (with-let x) (let ((y x)) y))
+(define (with-let* x) (let* ((y x) (z y)) z))
+(define (run n)
+  (do ((i 0 (+ i 1))
+       (acc 0 (+ acc (id 1) (with-let 1) (with-let* 1))))
+      ((= i n) acc)))
+(displayln (run 200000))
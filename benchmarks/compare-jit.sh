@@ -0,0 +1,12 @@
+#!/bin/bash
+# Times each benchmark on the tree-walker with and without --jit.
+# Usage: benchmarks/compare-jit.sh [path/to/mini_lisp]
+BIN=${1:-./release/mini_lisp}
+DIR=$(dirname "$0")
+TIMEFORMAT=%R
+printf "%-14s %10s %10s\n" benchmark tree jit
+for bench in fib tak sum-naturals; do
+    tree=$( { time "$BIN" "$DIR/$bench.lisp" > /dev/null; } 2>&1 )
+    jit=$( { time "$BIN" --jit "$DIR/$bench.lisp" > /dev/null; } 2>&1 )
+    printf "%-14s %9ss %9ss\n" "$bench" "$tree" "$jit"
+done
@@ -0,0 +1,13 @@
+; equal? between two separately built trees of 16383 nested lists.
+; ops: 327660 lists compared
+(define (tree depth)
+  (if (= depth 0)
+      (list 1 'leaf 2.5)
+      (list (tree (- depth 1)) depth (tree (- depth 1)))))
+(define a (tree 13))
+(define b (tree 13))
+(define (compare k hits)
+  (if (= k 0)
+      hits
+      (compare (- k 1) (if (equal? a b) (+ hits 1) hits))))
+(displayln (compare 20 0))
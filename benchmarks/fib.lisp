@@ -0,0 +1,7 @@
+; Doubly recursive Fibonacci: non-tail calls and fixnum arithmetic.
+; ops: 2692537 calls of fib
+(define (fib n)
+  (if (< n 2)
+      n
+      (+ (fib (- n 1)) (fib (- n 2)))))
+(displayln (fib 30))
@@ -0,0 +1,15 @@
+; Chains of append, map and filter over lists of tens of thousands.
+; ops: 500000 elements mapped
+(define (iota n)
+  (do ((i (- n 1) (- i 1))
+       (acc '() (cons i acc)))
+      ((< i 0) acc)))
+(define nums (iota 20000))
+(define (chain k acc)
+  (if (= k 0)
+      acc
+      (chain (- k 1)
+             (+ acc (length (filter even?
+                                    (map (lambda (x) (* x 3))
+                                         (append nums (filter odd? nums) nums))))))))
+(displayln (chain 10 0))
@@ -0,0 +1,13 @@
+; The README naturals stream: a promise forced for every element.
+; ops: 800000 forced promises
+(define (naturals n)
+  (cons n (delay (naturals (+ n 1)))))
+(define (force-nth stream n)
+  (if (= n 0)
+      (car stream)
+      (force-nth (force (cdr stream)) (- n 1))))
+(define (walk k)
+  (if (= k 0)
+      0
+      (+ (force-nth (naturals 0) 20000) (walk (- k 1)))))
+(displayln (walk 40))
@@ -0,0 +1,23 @@
+; The README quicksort on 2000 pseudo-random integers: filter, append
+; and a closure per partition.
+; ops: 124031 calls of quicksort
+(define (quicksort lst)
+  (if (null? lst)
+      '()
+      (let* ((pivot (car lst))
+             (rest (cdr lst))
+             (less (filter (lambda (x) (< x pivot)) rest))
+             (greater (filter (lambda (x) (>= x pivot)) rest)))
+        (append (quicksort less) (list pivot) (quicksort greater)))))
+; A linear congruential generator, so every run sorts the same list.
+(define (random-list n seed)
+  (if (= n 0)
+      '()
+      (cons seed (random-list (- n 1) (remainder (+ (* seed 1103515245) 12345) 2147483648)))))
+(define data (random-list 2000 42))
+(define (sort-times k)
+  (if (= k 0)
+      '()
+      (begin (quicksort data) (sort-times (- k 1)))))
+(sort-times 30)
+(displayln (car (quicksort data)))
@@ -0,0 +1,20 @@
+; Builds a report of twenty thousand formatted lines, then slices every
+; line back into its fields and checks them.
+; ops: 40000 lines built and parsed
+(define (row i)
+  (string-append "item-" (number->string i) ": "
+                 (number->string (* i i)) " units, "
+                 (if (even? i) "even" "odd")))
+(define (rows i acc)
+  (if (< i 0) acc (rows (- i 1) (cons (row i) acc))))
+(define report (string-join (rows 19999 '()) "\n"))
+(define (field line)
+  (do ((i 5 (+ i 1)))
+      ((string=? (string-ref line i) ":") (string->number (substring line 5 i)))))
+(define (check start i total)
+  (if (>= start (string-length report))
+      total
+      (let ((end (do ((j start (+ j 1)))
+                     ((or (= j (string-length report)) (string=? (string-ref report j) "\n")) j))))
+        (check (+ end 1) (+ i 1) (+ total (field (substring report start end)))))))
+(displayln (check 0 0 0))
@@ -0,0 +1,11 @@
+; The do loop from the README, run to 100000 a hundred times.
+; ops: 10000000 loop iterations
+(define (sum-naturals n)
+  (do ((i 0 (+ i 1))
+       (sum 0 (+ sum i)))
+      ((>= i n) sum)))
+(define (repeat k acc)
+  (if (= k 0)
+      acc
+      (repeat (- k 1) (+ acc (sum-naturals 100000)))))
+(displayln (repeat 100 0))
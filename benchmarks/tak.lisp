@@ -0,0 +1,9 @@
+; Takeuchi's function: deep non-tail recursion on three arguments.
+; ops: 2493349 calls of tak
+(define (tak x y z)
+  (if (not (< y x))
+      z
+      (tak (tak (- x 1) y z)
+           (tak (- y 1) z x)
+           (tak (- z 1) x y))))
+(displayln (tak 24 16 8))
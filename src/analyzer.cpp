@@ -0,0 +1,104 @@
+#include "./analyzer.h"
+#include "./forms.h"
+#include "./error.h"
+
+static const Symbol BEGIN = Symbol::intern("begin");
+static const Symbol DEFINE = Symbol::intern("define");
+
+std::optional<size_t> Scope::find(Symbol name) const {
+    for (size_t i = names.size(); i-- > 0;)
+        if (names[i] == name)
+            return i;
+    return std::nullopt;
+}
+
+size_t Scope::declare(Symbol name) {
+    if (auto slot = find(name))
+        return *slot;
+    names.push_back(name);
+    return names.size() - 1;
+}
+
+Analyzer Analyzer::enter(std::vector<Symbol> names) const {
+    return Analyzer(std::make_shared<Scope>(std::move(names), scope));
+}
+
+std::optional<size_t> Analyzer::declare(Symbol name) {
+    if (!scope)
+        return std::nullopt;
+    return scope->declare(name);
+}
+
+NodePtr Analyzer::analyze(const ValuePtr& expr) {
+    if (expr.isSelfEvaluating())
+        return std::make_shared<ConstantNode>(expr);
+    else if (auto symbol = expr.asSymbol())
+        return analyzeVariable(*symbol);
+    else if (expr.getType() == ValueType::PAIR) {
+        ValuePtr current = expr;
+        while (current.getType() == ValueType::PAIR)
+            current = static_cast<PairValue*>(current.get())->getCdr();
+        if (!current.isNil())
+            throw LispError("Malformed list: " + expr.toString());
+        auto pair = static_cast<PairValue*>(expr.get());
+        if (auto op = pair->getCar().asSymbol()) {
+            auto form = SPECIAL_FORMS.find(*op);
+            if (form != SPECIAL_FORMS.end())
+                return form->second(pair->getCdr().toVector(), *this);
+        }
+        auto op = analyze(pair->getCar());
+        return std::make_shared<CallNode>(std::move(op), analyzeAll(pair->getCdr().toVector()));
+    }
+    else if (expr.isNil())
+        throw LispError("Cannot evaluate nil");
+    else
+        throw LispError("Undefined expression type");
+}
+
+NodePtr Analyzer::analyzeVariable(Symbol name) const {
+    size_t depth = 0;
+    for (auto current = scope.get(); current; current = current->parent.get(), depth++) {
+        if (auto slot = current->find(name))
+            return std::make_shared<LocalVariableNode>(name, depth, *slot);
+    }
+    return std::make_shared<GlobalVariableNode>(name, depth);
+}
+
+// Internal defines get their slots before any of the body is analyzed, so
+// procedures defined side by side can refer to each other.
+static void declareDefinitions(const std::vector<ValuePtr>& forms, size_t begin, Analyzer& a) {
+    for (size_t i = begin; i < forms.size(); i++) {
+        if (forms[i].getType() != ValueType::PAIR)
+            continue;
+        auto pair = static_cast<PairValue*>(forms[i].get());
+        auto op = pair->getCar().asSymbol();
+        if (!op || pair->getCdr().getType() != ValueType::PAIR)
+            continue;
+        auto target = static_cast<PairValue*>(pair->getCdr().get())->getCar();
+        if (*op == BEGIN)
+            declareDefinitions(pair->getCdr().toVector(), 0, a);
+        else if (*op != DEFINE)
+            continue;
+        else if (auto name = target.asSymbol())
+            a.declare(*name);
+        else if (target.getType() == ValueType::PAIR) {
+            if (auto name = static_cast<PairValue*>(target.get())->getCar().asSymbol())
+                a.declare(*name);
+        }
+    }
+}
+
+NodePtr Analyzer::analyzeBody(const std::vector<ValuePtr>& forms, size_t begin) {
+    if (scope)
+        declareDefinitions(forms, begin, *this);
+    if (forms.size() == begin + 1)
+        return analyze(forms[begin]);
+    return std::make_shared<SequenceNode>(analyzeAll(forms, begin));
+}
+
+std::vector<NodePtr> Analyzer::analyzeAll(const std::vector<ValuePtr>& forms, size_t begin) {
+    std::vector<NodePtr> result;
+    for (size_t i = begin; i < forms.size(); i++)
+        result.push_back(analyze(forms[i]));
+    return result;
+}
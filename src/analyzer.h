@@ -0,0 +1,35 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include "./node.h"
+#include <optional>
+
+// Compile-time picture of a local frame: the name bound in each slot, and
+// the scope of the frame it is nested in. A null scope is the global frame.
+struct Scope {
+    std::vector<Symbol> names;
+    std::shared_ptr<Scope> parent;
+
+    Scope(std::vector<Symbol> names, std::shared_ptr<Scope> parent)
+        : names{std::move(names)}, parent{std::move(parent)} {}
+    std::optional<size_t> find(Symbol name) const;
+    size_t declare(Symbol name);
+};
+using ScopePtr = std::shared_ptr<Scope>;
+
+class Analyzer {
+private:
+    ScopePtr scope;
+public:
+    Analyzer(ScopePtr scope = nullptr) : scope{std::move(scope)} {}
+    const ScopePtr& getScope() const {return scope;}
+    Analyzer enter(std::vector<Symbol> names) const;
+    std::optional<size_t> declare(Symbol name);
+
+    NodePtr analyze(const ValuePtr& expr);
+    NodePtr analyzeVariable(Symbol name) const;
+    NodePtr analyzeBody(const std::vector<ValuePtr>& forms, size_t begin = 0);
+    std::vector<NodePtr> analyzeAll(const std::vector<ValuePtr>& forms, size_t begin = 0);
+};
+
+#endif
@@ -0,0 +1,524 @@
+#include "./bigint.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using Limbs = std::vector<uint32_t>;
+
+// Below this many limbs in the shorter operand, schoolbook multiplication
+// beats splitting further.
+static constexpr size_t KARATSUBA_THRESHOLD = 32;
+// Below this many limbs in the divisor or the quotient, Algorithm D beats
+// Burnikel-Ziegler's recursive division.
+static constexpr size_t BURNIKEL_ZIEGLER_THRESHOLD = 40;
+// Below this many limbs, decimal conversion divides by one limb at a time
+// rather than splitting the number by a power of ten.
+static constexpr size_t DECIMAL_SPLIT_THRESHOLD = 40;
+// The largest power of ten in a limb, for decimal conversion.
+static constexpr uint32_t DECIMAL_BASE = 1000000000;
+static constexpr size_t DECIMAL_DIGITS = 9;
+
+static void normalize(Limbs& limbs){
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+}
+
+static Limbs trimmed(const uint32_t* limbs, size_t size){
+    Limbs result(limbs, limbs + size);
+    normalize(result);
+    return result;
+}
+
+static int compareMagnitude(const Limbs& a, const Limbs& b){
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static Limbs addMagnitude(const Limbs& a, const Limbs& b){
+    const Limbs& longer = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    Limbs result(longer.size() + 1);
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < shorter.size(); i++) {
+        uint64_t sum = carry + longer[i] + shorter[i];
+        result[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (; i < longer.size(); i++) {
+        uint64_t sum = carry + longer[i];
+        result[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    result[longer.size()] = static_cast<uint32_t>(carry);
+    normalize(result);
+    return result;
+}
+
+// a - b, where a is at least b.
+static Limbs subtractMagnitude(const Limbs& a, const Limbs& b){
+    Limbs result(a.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        int64_t difference = static_cast<int64_t>(a[i]) - borrow - (i < b.size() ? b[i] : 0);
+        borrow = difference < 0;
+        result[i] = static_cast<uint32_t>(difference + (borrow << 32));
+    }
+    normalize(result);
+    return result;
+}
+
+// Adds source, shifted up by shift limbs, into target, which is long enough
+// to hold the sum.
+static void addShifted(Limbs& target, const Limbs& source, size_t shift){
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < source.size(); i++) {
+        uint64_t sum = carry + target[i + shift] + source[i];
+        target[i + shift] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (i += shift; carry; i++) {
+        uint64_t sum = carry + target[i];
+        target[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+static Limbs schoolbook(const uint32_t* a, size_t n, const uint32_t* b, size_t m){
+    Limbs result(n + m);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < m; j++) {
+            uint64_t product = static_cast<uint64_t>(a[i]) * b[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        result[i + m] = static_cast<uint32_t>(carry);
+    }
+    normalize(result);
+    return result;
+}
+
+// Karatsuba: with a = a1 B + a0 and b = b1 B + b0, the middle term
+// a1 b0 + a0 b1 is (a0 + a1)(b0 + b1) - a0 b0 - a1 b1, so each level needs
+// three half-size products instead of four.
+static Limbs multiplyMagnitude(const uint32_t* a, size_t n, const uint32_t* b, size_t m){
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m == 0)
+        return {};
+    if (m < KARATSUBA_THRESHOLD)
+        return schoolbook(a, n, b, m);
+    size_t half = n / 2;
+    Limbs result(n + m + 1);
+    if (m <= half) {
+        // b has no upper half; multiply it by each half of a.
+        addShifted(result, multiplyMagnitude(a, half, b, m), 0);
+        addShifted(result, multiplyMagnitude(a + half, n - half, b, m), half);
+        normalize(result);
+        return result;
+    }
+    auto a0 = trimmed(a, half);
+    auto b0 = trimmed(b, half);
+    auto a1 = trimmed(a + half, n - half);
+    auto b1 = trimmed(b + half, m - half);
+    auto low = multiplyMagnitude(a0.data(), a0.size(), b0.data(), b0.size());
+    auto high = multiplyMagnitude(a1.data(), a1.size(), b1.data(), b1.size());
+    auto sumA = addMagnitude(a0, a1);
+    auto sumB = addMagnitude(b0, b1);
+    auto middle = multiplyMagnitude(sumA.data(), sumA.size(), sumB.data(), sumB.size());
+    middle = subtractMagnitude(subtractMagnitude(middle, low), high);
+    addShifted(result, low, 0);
+    addShifted(result, middle, half);
+    addShifted(result, high, 2 * half);
+    normalize(result);
+    return result;
+}
+
+// Divides in place by a single limb and returns the remainder.
+static uint32_t divideSmall(Limbs& limbs, uint32_t divisor){
+    uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | limbs[i];
+        limbs[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    normalize(limbs);
+    return static_cast<uint32_t>(remainder);
+}
+
+// Multiplies in place by a single limb and adds another.
+static void multiplyAddSmall(Limbs& limbs, uint32_t factor, uint32_t addend){
+    uint64_t carry = addend;
+    for (auto& limb : limbs) {
+        uint64_t product = static_cast<uint64_t>(limb) * factor + carry;
+        limb = static_cast<uint32_t>(product);
+        carry = product >> 32;
+    }
+    if (carry)
+        limbs.push_back(static_cast<uint32_t>(carry));
+}
+
+static int leadingZeros(uint32_t limb){
+    int count = 0;
+    while (!(limb & 0x80000000u)) {
+        limb <<= 1;
+        count++;
+    }
+    return count;
+}
+
+// Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) for a divisor of at least two
+// limbs and a dividend at least as large.
+static void divideMagnitude(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder){
+    size_t n = v.size();
+    size_t m = u.size() - n;
+    int shift = leadingZeros(v.back());
+    Limbs vn(n);
+    Limbs un(u.size() + 1);
+    for (size_t i = n; i-- > 0;)
+        vn[i] = (v[i] << shift) | (shift && i > 0 ? v[i - 1] >> (32 - shift) : 0);
+    un[u.size()] = shift ? u.back() >> (32 - shift) : 0;
+    for (size_t i = u.size(); i-- > 0;)
+        un[i] = (u[i] << shift) | (shift && i > 0 ? u[i - 1] >> (32 - shift) : 0);
+
+    constexpr uint64_t BASE = uint64_t{1} << 32;
+    quotient.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        uint64_t numerator = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+        uint64_t estimate = numerator / vn[n - 1];
+        uint64_t rest = numerator % vn[n - 1];
+        while (estimate >= BASE || estimate * vn[n - 2] > ((rest << 32) | un[j + n - 2])) {
+            estimate--;
+            rest += vn[n - 1];
+            if (rest >= BASE)
+                break;
+        }
+        int64_t borrow = 0;
+        int64_t difference;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t product = estimate * vn[i];
+            difference = static_cast<int64_t>(un[i + j]) - borrow - static_cast<int64_t>(product & 0xffffffffu);
+            un[i + j] = static_cast<uint32_t>(difference);
+            borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+        }
+        difference = static_cast<int64_t>(un[j + n]) - borrow;
+        un[j + n] = static_cast<uint32_t>(difference);
+        quotient[j] = static_cast<uint32_t>(estimate);
+        if (difference < 0) {
+            // The estimate was one too large; add the divisor back.
+            quotient[j]--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = static_cast<uint64_t>(un[i + j]) + vn[i] + carry;
+                un[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            un[j + n] += static_cast<uint32_t>(carry);
+        }
+    }
+    normalize(quotient);
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; i++)
+        remainder[i] = (un[i] >> shift) | (shift ? un[i + 1] << (32 - shift) : 0);
+    normalize(remainder);
+}
+
+// The count limbs of a starting at from, as a number.
+static Limbs slice(const Limbs& a, size_t from, size_t count){
+    if (from >= a.size())
+        return {};
+    return trimmed(a.data() + from, std::min(count, a.size() - from));
+}
+
+// high B^n + low, where low is less than B^n.
+static Limbs join(const Limbs& high, const Limbs& low, size_t n){
+    if (high.empty())
+        return low;
+    Limbs result = low;
+    result.resize(n);
+    result.insert(result.end(), high.begin(), high.end());
+    return result;
+}
+
+static Limbs shiftLeft(const Limbs& a, size_t limbs, int bits){
+    Limbs result(limbs, 0);
+    uint32_t carry = 0;
+    for (auto limb : a) {
+        result.push_back((limb << bits) | carry);
+        carry = bits ? limb >> (32 - bits) : 0;
+    }
+    result.push_back(carry);
+    normalize(result);
+    return result;
+}
+
+static Limbs shiftRight(const Limbs& a, size_t limbs, int bits){
+    Limbs result;
+    for (size_t i = limbs; i < a.size(); i++)
+        result.push_back((a[i] >> bits) | (bits && i + 1 < a.size() ? a[i + 1] << (32 - bits) : 0));
+    normalize(result);
+    return result;
+}
+
+static void divideTwoByOne(const Limbs& a, const Limbs& b, size_t n, Limbs& quotient, Limbs& remainder);
+
+// Burnikel and Ziegler, "Fast Recursive Division" (1998): divides a of at
+// most three half-limb blocks by b of two, where a < B^half b and the top
+// bit of b is set. The quotient is estimated from the top blocks and
+// corrected at most twice.
+static void divideThreeByTwo(const Limbs& a, const Limbs& b, size_t half, Limbs& quotient, Limbs& remainder){
+    auto b1 = slice(b, half, half);
+    auto b2 = slice(b, 0, half);
+    auto a12 = slice(a, half, 2 * half);
+    Limbs rest;
+    if (compareMagnitude(slice(a, 2 * half, half), b1) < 0)
+        divideTwoByOne(a12, b1, half, quotient, rest);
+    else {
+        quotient.assign(half, 0xffffffffu);
+        rest = subtractMagnitude(addMagnitude(a12, b1), join(b1, {}, half));
+    }
+    auto product = multiplyMagnitude(quotient.data(), quotient.size(), b2.data(), b2.size());
+    auto estimate = join(rest, slice(a, 0, half), half);
+    while (compareMagnitude(estimate, product) < 0) {
+        quotient = subtractMagnitude(quotient, {1});
+        estimate = addMagnitude(estimate, b);
+    }
+    remainder = subtractMagnitude(estimate, product);
+}
+
+// Divides a of at most 2n limbs by b of exactly n limbs with its top bit
+// set, where a < B^n b, by two three-by-two steps on halves.
+static void divideTwoByOne(const Limbs& a, const Limbs& b, size_t n, Limbs& quotient, Limbs& remainder){
+    if (n % 2 || n < BURNIKEL_ZIEGLER_THRESHOLD) {
+        if (compareMagnitude(a, b) < 0) {
+            quotient.clear();
+            remainder = a;
+        }
+        else divideMagnitude(a, b, quotient, remainder);
+        return;
+    }
+    size_t half = n / 2;
+    Limbs high;
+    Limbs rest;
+    divideThreeByTwo(slice(a, half, 3 * half), b, half, high, rest);
+    divideThreeByTwo(join(rest, slice(a, 0, half), half), b, half, quotient, remainder);
+    quotient = join(high, quotient, half);
+}
+
+// Divides u by v, which has at least two limbs and is at most u. Large
+// divisions scale v to a block size that halves evenly down to the
+// threshold and run the dividend through it an n-limb block at a time.
+static void divideLarge(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder){
+    size_t s = v.size();
+    if (s < BURNIKEL_ZIEGLER_THRESHOLD || u.size() - s < BURNIKEL_ZIEGLER_THRESHOLD) {
+        divideMagnitude(u, v, quotient, remainder);
+        return;
+    }
+    size_t blocks = 1;
+    while (s / blocks >= BURNIKEL_ZIEGLER_THRESHOLD)
+        blocks *= 2;
+    size_t n = (s + blocks - 1) / blocks * blocks;
+    size_t limbShift = n - s;
+    int bitShift = leadingZeros(v.back());
+    auto vn = shiftLeft(v, limbShift, bitShift);
+    auto un = shiftLeft(u, limbShift, bitShift);
+    // The top block is shorter than n limbs, so it is less than vn.
+    size_t t = un.size() / n + 1;
+    quotient.assign((t - 1) * n + 1, 0);
+    auto current = slice(un, (t - 2) * n, 2 * n);
+    for (size_t i = t - 1; i-- > 0;) {
+        Limbs part;
+        Limbs rest;
+        divideTwoByOne(current, vn, n, part, rest);
+        addShifted(quotient, part, i * n);
+        if (i > 0)
+            current = join(rest, slice(un, (i - 1) * n, n), n);
+        else
+            remainder = shiftRight(rest, limbShift, bitShift);
+    }
+    normalize(quotient);
+}
+
+// u divided by any nonzero v.
+static void divideAny(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder){
+    if (compareMagnitude(u, v) < 0) {
+        quotient.clear();
+        remainder = u;
+    }
+    else if (v.size() == 1) {
+        quotient = u;
+        uint32_t rest = divideSmall(quotient, v[0]);
+        remainder.clear();
+        if (rest)
+            remainder.push_back(rest);
+    }
+    else divideLarge(u, v, quotient, remainder);
+}
+
+// Appends value, which is less than powers[level + 1], in decimal; padded
+// with leading zeros to width digits, if given. Large values are split by
+// powers[level] = 10^(9 2^level) into two halves converted separately.
+static void appendDecimal(const Limbs& value, const std::vector<Limbs>& powers, size_t level, size_t width, std::string& out){
+    if (value.size() >= DECIMAL_SPLIT_THRESHOLD && level < powers.size()) {
+        while (level > 0 && compareMagnitude(value, powers[level]) < 0)
+            level--;
+        size_t low = DECIMAL_DIGITS << level;
+        Limbs high;
+        Limbs rest;
+        divideAny(value, powers[level], high, rest);
+        appendDecimal(high, powers, level - (level > 0), width > low ? width - low : 0, out);
+        appendDecimal(rest, powers, level - (level > 0), low, out);
+        return;
+    }
+    Limbs rest = value;
+    std::vector<uint32_t> chunks;
+    while (!rest.empty())
+        chunks.push_back(divideSmall(rest, DECIMAL_BASE));
+    std::string digits;
+    for (size_t i = chunks.size(); i-- > 0;) {
+        auto chunk = std::to_string(chunks[i]);
+        if (i + 1 < chunks.size())
+            digits.append(DECIMAL_DIGITS - chunk.size(), '0');
+        digits += chunk;
+    }
+    if (digits.size() < width)
+        out.append(width - digits.size(), '0');
+    out += digits;
+}
+
+BigInt::BigInt(bool negative, Limbs limbs) : negative{negative}, limbs{std::move(limbs)} {
+    normalize(this->limbs);
+    if (this->limbs.empty())
+        this->negative = false;
+}
+
+BigInt::BigInt(int64_t value) : negative{value < 0} {
+    uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    limbs = {static_cast<uint32_t>(magnitude), static_cast<uint32_t>(magnitude >> 32)};
+    normalize(limbs);
+}
+
+std::optional<BigInt> BigInt::parse(std::string_view text){
+    bool negative = false;
+    if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+        negative = text[0] == '-';
+        text.remove_prefix(1);
+    }
+    if (text.empty())
+        return std::nullopt;
+    Limbs limbs;
+    // The first chunk takes whatever is left over so the rest are full.
+    size_t chunk = text.size() % DECIMAL_DIGITS;
+    if (chunk == 0)
+        chunk = DECIMAL_DIGITS;
+    for (size_t start = 0; start < text.size(); start += chunk, chunk = DECIMAL_DIGITS) {
+        uint32_t value = 0;
+        uint32_t scale = 1;
+        for (size_t i = start; i < start + chunk; i++) {
+            if (text[i] < '0' || text[i] > '9')
+                return std::nullopt;
+            value = value * 10 + static_cast<uint32_t>(text[i] - '0');
+            scale *= 10;
+        }
+        multiplyAddSmall(limbs, scale, value);
+    }
+    return BigInt(negative, std::move(limbs));
+}
+
+bool BigInt::fitsInt64() const {
+    if (limbs.size() < 2)
+        return true;
+    if (limbs.size() > 2)
+        return false;
+    uint64_t magnitude = (static_cast<uint64_t>(limbs[1]) << 32) | limbs[0];
+    return magnitude <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+}
+
+int64_t BigInt::toInt64() const {
+    uint64_t magnitude = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+        magnitude = (magnitude << 32) | limbs[i];
+    return static_cast<int64_t>(negative ? 0 - magnitude : magnitude);
+}
+
+double BigInt::toDouble() const {
+    // The top three limbs hold more bits than a double keeps.
+    double result = 0;
+    size_t top = std::min<size_t>(limbs.size(), 3);
+    for (size_t i = 0; i < top; i++)
+        result = result * 4294967296.0 + limbs[limbs.size() - 1 - i];
+    result = std::ldexp(result, static_cast<int>(32 * (limbs.size() - top)));
+    return negative ? -result : result;
+}
+
+// Splits the number in halves by precomputed powers of 10^9, so with
+// recursive division the conversion costs a few multiplications of its
+// size instead of one single-limb division per nine digits.
+std::string BigInt::toString() const {
+    if (limbs.empty())
+        return "0";
+    std::vector<Limbs> powers{{DECIMAL_BASE}};
+    while (powers.back().size() * 2 <= limbs.size() + 1) {
+        const auto& last = powers.back();
+        powers.push_back(multiplyMagnitude(last.data(), last.size(), last.data(), last.size()));
+    }
+    std::string result = negative ? "-" : "";
+    appendDecimal(limbs, powers, powers.size() - 1, 0, result);
+    return result;
+}
+
+int BigInt::compare(const BigInt& other) const {
+    if (negative != other.negative)
+        return negative ? -1 : 1;
+    int magnitude = compareMagnitude(limbs, other.limbs);
+    return negative ? -magnitude : magnitude;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(!negative, limbs);
+}
+
+BigInt operator+(const BigInt& a, const BigInt& b){
+    if (a.negative == b.negative)
+        return BigInt(a.negative, addMagnitude(a.limbs, b.limbs));
+    if (compareMagnitude(a.limbs, b.limbs) >= 0)
+        return BigInt(a.negative, subtractMagnitude(a.limbs, b.limbs));
+    return BigInt(b.negative, subtractMagnitude(b.limbs, a.limbs));
+}
+
+BigInt operator-(const BigInt& a, const BigInt& b){
+    return a + -b;
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b){
+    return BigInt(a.negative != b.negative, multiplyMagnitude(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size()));
+}
+
+void BigInt::divide(const BigInt& dividend, const BigInt& divisor, BigInt& quotient, BigInt& remainder){
+    Limbs q;
+    Limbs r;
+    divideAny(dividend.limbs, divisor.limbs, q, r);
+    quotient = BigInt(dividend.negative != divisor.negative, std::move(q));
+    remainder = BigInt(dividend.negative, std::move(r));
+}
+
+BigInt BigInt::pow(BigInt base, uint64_t exponent){
+    BigInt result(1);
+    while (exponent) {
+        if (exponent & 1)
+            result = result * base;
+        exponent >>= 1;
+        if (exponent)
+            base = base * base;
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// An arbitrary-precision integer: a sign and a magnitude in base 2^32,
+// least significant limb first and without leading zero limbs. Zero has no
+// limbs and is never negative.
+class BigInt {
+private:
+    using Limbs = std::vector<uint32_t>;
+    bool negative = false;
+    Limbs limbs;
+    BigInt(bool negative, Limbs limbs);
+public:
+    BigInt() = default;
+    BigInt(int64_t value);
+    // Parses an optionally signed run of decimal digits.
+    static std::optional<BigInt> parse(std::string_view text);
+
+    bool isZero() const {return limbs.empty();}
+    bool isNegative() const {return negative;}
+    bool isOdd() const {return !limbs.empty() && (limbs[0] & 1);}
+    bool fitsInt64() const;
+    int64_t toInt64() const;
+    // The nearest double, or an infinity when out of range.
+    double toDouble() const;
+    std::string toString() const;
+
+    // Negative, zero or positive as this is less than, equal to or greater
+    // than other.
+    int compare(const BigInt& other) const;
+    BigInt operator-() const;
+    friend BigInt operator+(const BigInt& a, const BigInt& b);
+    friend BigInt operator-(const BigInt& a, const BigInt& b);
+    friend BigInt operator*(const BigInt& a, const BigInt& b);
+    // Truncating division: the quotient rounds toward zero and the
+    // remainder takes the sign of the dividend. divisor must not be zero.
+    static void divide(const BigInt& dividend, const BigInt& divisor, BigInt& quotient, BigInt& remainder);
+    static BigInt pow(BigInt base, uint64_t exponent);
+};
+
+#endif
@@ -1,623 +1,1285 @@
 #include "./builtin.h"
 #include "./error.h"
 #include <iostream> 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <functional>
+#include <limits>
+#include "./number.h"
+#include "./f64kernels.h"
+#include "./equality.h"
+#include "./hamt.h"
+#include "./tokenizer.h"
+#include "./parser.h"
 
 class EvalEnv;
 
-ValuePtr apply(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr apply(ValueSpan params, EvalEnv& e){
     if(params.size() != 2)
         throw ArgumentError();
     auto proc = params[0];
     auto islist = list({params[1]}, e);
-    if(!static_cast<BooleanValue*>(islist.get())->getValue())
+    if(!islist.asBoolean())
         throw LispError("Not a list");
-    std::vector<ValuePtr> origin = static_cast<PairValue*>(params[1].get())->toVector();
-    std::vector<ValuePtr> result;
-    for(const auto& i:origin)
-        result.push_back(e.eval(i));
-    if(proc->getType() == ValueType::BUILTIN_PROC){
-        auto func = static_cast<BuiltinProcValue*>(proc.get())->getFunc();
-        return func(result, e);
+    std::vector<ValuePtr> result = params[1].toVector();
+    if(proc.getType() == ValueType::BUILTIN_PROC){
+        return static_cast<BuiltinProcValue*>(proc.get())->call(result, e);
     }
-    else if(proc->getType() == ValueType::LAMBDA){
+    else if(proc.getType() == ValueType::LAMBDA){
         auto lambda = static_cast<LambdaValue*>(proc.get());
-        return lambda->apply(result);  
+        return lambda->apply(result);
     } 
     else{
         throw LispError("Cannot apply a non-procedure.");
     }
 }
 
-ValuePtr display(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr display(ValueSpan params, EvalEnv&){
     for(const auto& i: params){
-        if(i->getType() == ValueType::STRING)
+        if(i.getType() == ValueType::STRING)
             std::cout << static_cast<StringValue*>(i.get())->getValue();
-        else std::cout << i->toString();
+        else std::cout << i.toString();
     }
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr newline(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr newline(ValueSpan params, EvalEnv&){
     std::cout << std::endl;
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr printer(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr printer(ValueSpan params, EvalEnv&){
     for(const auto& i: params){
-        std::cout << i->toString() << std::endl;
+        std::cout << i.toString() << std::endl;
     }
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr displayln(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr displayln(ValueSpan params, EvalEnv& e){
     auto result = display(params, e);
     auto result2 = newline(params, e);
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }   
 
-ValuePtr Error(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr Error(ValueSpan params, EvalEnv&){
     if(params.size() > 1)
         throw ArgumentError();
     if(params.size() == 0)
         throw LispError("");
-    throw LispError(params[0]->toString());
+    throw LispError(params[0].toString());
 }
 
-ValuePtr Eval(const std::vector<ValuePtr>& params, EvalEnv& env){
+ValuePtr Eval(ValueSpan params, EvalEnv& env){
     if(params.size() != 1)
         throw ArgumentError();
     return env.eval(params[0]);
 }
 
-ValuePtr Exit(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr Exit(ValueSpan params, EvalEnv&){
     if (params.size() == 0)
         exit(0);
     else if (params.size() == 1){
-        if(!params[0]->isInteger())
+        if(!params[0].isInteger())
             throw LispError("Cannot exit with a non-integer value.");
-        exit(static_cast<NumericValue*>(params[0].get())->asNumber());
+        exit(static_cast<int>(params[0].asNumber()));
     }
     else throw  ArgumentError();
 }
 
 
-ValuePtr add(const std::vector<ValuePtr>& params, EvalEnv&){
-    double result = 0;
-    for(const auto& i: params){
-        if(!i->isNumber())
-            throw LispError("Cannot add a non-numeric value.");
-        result += static_cast<NumericValue*>(i.get())->asNumber();
+// Folds the operands from index i on into init with op, after checking that
+// every operand is a number. Exact integers are
+// folded with overflow-checked int64 arithmetic while they fit, and as
+// BigInts once they do not; the rest of the fold, from the first inexact
+// operand on, is done in doubles.
+template <typename Exact, typename Op>
+static ValuePtr foldNumbers(ValueSpan params, size_t i, ValuePtr init, Exact exact, Op op, const char* error){
+    for(const auto& param: params)
+        if(!param.isNumber())
+            throw LispError(error);
+    if(init.isInt64()){
+        int64_t result = init.asInteger();
+        for(; i < params.size(); i++){
+            int64_t next;
+            if(!params[i].isInt64() || !exact(result, params[i].asInteger(), next))
+                break;
+            result = next;
+        }
+        if(i == params.size())
+            return ValuePtr::integer(result);
+        init = ValuePtr::integer(result);
     }
-    return std::make_shared<NumericValue>(result);  
+    if(init.isExact() && i < params.size() && params[i].isExact()){
+        BigInt result = init.asBigInt();
+        for(; i < params.size() && params[i].isExact(); i++)
+            result = op(result, params[i].asBigInt());
+        if(i == params.size())
+            return ValuePtr::integer(result);
+        init = ValuePtr::integer(result);
+    }
+    double result = init.asNumber();
+    for(; i < params.size(); i++)
+        result = op(result, params[i].asNumber());
+    return ValuePtr::number(result);
+}
+
+ValuePtr add(ValueSpan params, EvalEnv&){
+    if (params.size() == 0) return ValuePtr::integer(0);
+    return foldNumbers(params, 1, params[0], checkedAdd, std::plus<>(), "Cannot add a non-numeric value.");
 }
 
-ValuePtr sub(const std::vector<ValuePtr>& params, EvalEnv&){
-    double result = 0;
+ValuePtr sub(ValueSpan params, EvalEnv&){
     if (params.size() == 0) throw ArgumentError();
-    if (params.size() == 1) {
-        if(!params[0]->isNumber())
-            throw LispError("Cannot substract a non-numeric value.");
-        result = -static_cast<NumericValue*>(params[0].get())->asNumber();
-        return std::make_shared<NumericValue>(result);  
-    }
-    for(const auto& i: params){
-        if(!i->isNumber())
-            throw LispError("Cannot substract a non-numeric value.");
-        result -= static_cast<NumericValue*>(i.get())->asNumber();
-    }
-    double first_elem = static_cast<NumericValue*>(params[0].get())->asNumber();
-    result += 2*first_elem;
-    return std::make_shared<NumericValue>(result);  
+    if (params.size() == 1)
+        return foldNumbers(params, 0, ValuePtr::integer(0), checkedSub, std::minus<>(), "Cannot substract a non-numeric value.");
+    return foldNumbers(params, 1, params[0], checkedSub, std::minus<>(), "Cannot substract a non-numeric value.");
 }
 
-ValuePtr mul(const std::vector<ValuePtr>& params, EvalEnv&){
-    double result = 1;
-    for(const auto& i: params){
-        if(!i->isNumber())
-            throw LispError("Cannot multiply a non-numeric value.");
-        result *= static_cast<NumericValue*>(i.get())->asNumber();
-    }
-    return std::make_shared<NumericValue>(result);  
+ValuePtr mul(ValueSpan params, EvalEnv&){
+    if (params.size() == 0) return ValuePtr::integer(1);
+    return foldNumbers(params, 1, params[0], checkedMul, std::multiplies<>(), "Cannot multiply a non-numeric value.");
+}
+
+// Two-argument entry points for +, - and *: fixnums that do not overflow
+// are handled here, everything else by the general fold.
+static ValuePtr add2(const ValuePtr& x, const ValuePtr& y, EvalEnv& e){
+    int64_t result;
+    if(x.isFixnum() && y.isFixnum() && checkedAdd(x.asInteger(), y.asInteger(), result))
+        return ValuePtr::integer(result);
+    return add({x, y}, e);
+}
+
+static ValuePtr sub2(const ValuePtr& x, const ValuePtr& y, EvalEnv& e){
+    int64_t result;
+    if(x.isFixnum() && y.isFixnum() && checkedSub(x.asInteger(), y.asInteger(), result))
+        return ValuePtr::integer(result);
+    return sub({x, y}, e);
 }
 
-ValuePtr divide(const std::vector<ValuePtr>& params, EvalEnv&){
-    double result = 1;
+static ValuePtr mul2(const ValuePtr& x, const ValuePtr& y, EvalEnv& e){
+    int64_t result;
+    if(x.isFixnum() && y.isFixnum() && checkedMul(x.asInteger(), y.asInteger(), result))
+        return ValuePtr::integer(result);
+    return mul({x, y}, e);
+}
+
+// Exact while each division leaves no remainder.
+ValuePtr divide(ValueSpan params, EvalEnv&){
     if (params.size() == 0) throw ArgumentError();
-    if (params.size() == 1){
-        if(!params[0]->isNumber())
-            throw LispError("Cannot divide a non-numeric value.");
-        result = 1/static_cast<NumericValue*>(params[0].get())->asNumber();
-        return std::make_shared<NumericValue>(result);  
-    }
     for(const auto& i: params){
-        if(!i->isNumber())
+        if(!i.isNumber())
             throw LispError("Cannot divide a non-numeric value.");
-        double temp = static_cast<NumericValue*>(i.get())->asNumber();
-        if(temp == 0) throw LispError("Division by zero.");
-        result /= temp;
     }
-    double first_elem = static_cast<NumericValue*>(params[0].get())->asNumber();
-    result = result * first_elem * first_elem;
-    return std::make_shared<NumericValue>(result);  
+    size_t i = params.size() == 1 ? 0 : 1;
+    auto numerator = params.size() == 1 ? ValuePtr::integer(1) : params[0];
+    for(size_t j = i; j < params.size(); j++){
+        if(params[j].asNumber() == 0) throw LispError("Division by zero.");
+    }
+    if(numerator.isInt64()){
+        int64_t result = numerator.asInteger();
+        for(; i < params.size() && params[i].isInt64(); i++){
+            int64_t divisor = params[i].asInteger();
+            if(divisor == -1 ? result == std::numeric_limits<int64_t>::min() : result % divisor != 0)
+                break;
+            result /= divisor;
+        }
+        if(i == params.size())
+            return ValuePtr::integer(result);
+        numerator = ValuePtr::integer(result);
+    }
+    if(numerator.isExact()){
+        BigInt result = numerator.asBigInt();
+        for(; i < params.size() && params[i].isExact(); i++){
+            BigInt quotient, remainder;
+            BigInt::divide(result, params[i].asBigInt(), quotient, remainder);
+            if(!remainder.isZero())
+                break;
+            result = std::move(quotient);
+        }
+        if(i == params.size())
+            return ValuePtr::integer(result);
+        numerator = ValuePtr::integer(result);
+    }
+    double result = numerator.asNumber();
+    for(; i < params.size(); i++)
+        result /= params[i].asNumber();
+    return ValuePtr::number(result);
 }
 
-ValuePtr ABS(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr ABS(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    if(!params[0]->isNumber())
+    if(!params[0].isNumber())
         throw LispError("Cannot take the absolute value of a non-numeric value.");
-    double result = std::abs(static_cast<NumericValue*>(params[0].get())->asNumber());
-    return std::make_shared<NumericValue>(result);  
+    if(params[0].isInt64() && params[0].asInteger() != std::numeric_limits<int64_t>::min())
+        return ValuePtr::integer(std::abs(params[0].asInteger()));
+    if(params[0].isExact()){
+        auto value = params[0].asBigInt();
+        return ValuePtr::integer(value.isNegative() ? -value : value);
+    }
+    double result = std::abs(params[0].asNumber());
+    return ValuePtr::number(result);  
 }
 
-ValuePtr expt(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr expt(ValueSpan params, EvalEnv&){
     if(params.size() != 2)
         throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
+    if(!params[0].isNumber() || !params[1].isNumber())
         throw LispError("Non-numeric value");
-    double base = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double power = static_cast<NumericValue*>(params[1].get())->asNumber();
+    double base = params[0].asNumber();
+    double power = params[1].asNumber();
     if(base == 0 && power == 0) throw LispError("Undefined mathematic form");
+    // An exact base to a non-negative exact power, by repeated squaring;
+    // in int64 arithmetic first, and as a BigInt if that overflows.
+    if(params[0].isExact() && params[1].isInt64() && params[1].asInteger() >= 0){
+        if(params[0].isInt64()){
+            int64_t square = params[0].asInteger();
+            int64_t exponent = params[1].asInteger();
+            int64_t result = 1;
+            bool fits = true;
+            while(fits && exponent > 0){
+                if(exponent & 1)
+                    fits = checkedMul(result, square, result);
+                exponent >>= 1;
+                if(fits && exponent > 0)
+                    fits = checkedMul(square, square, square);
+            }
+            if(fits)
+                return ValuePtr::integer(result);
+        }
+        return ValuePtr::integer(BigInt::pow(params[0].asBigInt(), static_cast<uint64_t>(params[1].asInteger())));
+    }
     double result = std::pow(base, power);
-    return std::make_shared<NumericValue>(result);  
+    return ValuePtr::number(result);  
 }
 
-ValuePtr quotient(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
+// The truncated quotient and remainder of two exact integers.
+static std::pair<ValuePtr, ValuePtr> divideExact(const ValuePtr& x, const ValuePtr& y){
+    if(x.isInt64() && y.isInt64()){
+        int64_t a = x.asInteger();
+        int64_t b = y.asInteger();
+        if(b != -1 || a != std::numeric_limits<int64_t>::min())
+            return {ValuePtr::integer(a / b), ValuePtr::integer(a % b)};
+    }
+    BigInt quotient, remainder;
+    BigInt::divide(x.asBigInt(), y.asBigInt(), quotient, remainder);
+    return {ValuePtr::integer(quotient), ValuePtr::integer(remainder)};
+}
+
+ValuePtr quotient(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv&){
+    if(!dividend.isNumber() || !divisor.isNumber())
         throw LispError("Non-numeric value");
-    double x = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double y = static_cast<NumericValue*>(params[1].get())->asNumber();
+    double x = dividend.asNumber();
+    double y = divisor.asNumber();
     if(y == 0) throw LispError("Division by zero");
-    return std::make_shared<NumericValue>(static_cast<int>(x/y));  
+    if(dividend.isExact() && divisor.isExact())
+        return divideExact(dividend, divisor).first;
+    return ValuePtr::number(std::trunc(x/y));  
 }
 
-ValuePtr modulo(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber()){
+ValuePtr modulo(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv& e){
+    if(!dividend.isNumber() || !divisor.isNumber()){
         throw LispError("Non-numeric value");
     }
-    double x = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double y = static_cast<NumericValue*>(params[1].get())->asNumber();
+    double x = dividend.asNumber();
+    double y = divisor.asNumber();
     if(y == 0) throw LispError("Division by zero.");
+    if(dividend.isExact() && divisor.isExact()){
+        // The remainder, moved to the sign of the divisor.
+        auto remainder = divideExact(dividend, divisor).second;
+        double sign = remainder.asNumber();
+        if(sign != 0 && (sign < 0) != (y < 0))
+            return add({remainder, divisor}, e);
+        return remainder;
+    }
     double result = x - y * std::floor(x / y);
-    return std::make_shared<NumericValue>(result);
+    return ValuePtr::number(result);
 }
 
-ValuePtr Remainder(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber()){
+ValuePtr Remainder(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv&){
+    if(!dividend.isNumber() || !divisor.isNumber()){
         throw LispError("Non-numeric value");
     }
-    double x = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double y = static_cast<NumericValue*>(params[1].get())->asNumber();
+    double x = dividend.asNumber();
+    double y = divisor.asNumber();
     if(y == 0) throw LispError("Division by zero.");
-    int quotient = static_cast<int>(x/y);
-    return std::make_shared<NumericValue>(x - quotient*y);
+    if(dividend.isExact() && divisor.isExact())
+        return divideExact(dividend, divisor).second;
+    return ValuePtr::number(x - std::trunc(x/y)*y);
 }
 
-ValuePtr eq(const std::vector<ValuePtr>& params, EvalEnv& e){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(params[0]->getType() != params[1]->getType())
-        return std::make_shared<BooleanValue>(false);
-    auto type = params[0]->getType();
-    if(type==ValueType::BOOLEAN||type==ValueType::NUMERIC||type==ValueType::SYMBOL||type==ValueType::LAMBDA||type==ValueType::BUILTIN_PROC||type==ValueType::NIL)
-        return equal(params, e);
-    else
-        return std::make_shared<BooleanValue>(params[0] == params[1]);
+ValuePtr eq(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return ValuePtr::boolean(Equality::eq(x, y));
 }
 
-ValuePtr equal(const std::vector<ValuePtr>& params, EvalEnv& e){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(params[0]->getType() != params[1]->getType())
-        return std::make_shared<BooleanValue>(false);
-    if(params[0]->isAtom())
-        return std::make_shared<BooleanValue>(params[0]->toString() == params[1]->toString());
-    else{
-        bool islistLHS = static_cast<BooleanValue*>(list({params[0]}, e).get())->getValue();
-        bool islistRHS = static_cast<BooleanValue*>(list({params[1]}, e).get())->getValue();
-        if(islistLHS != islistRHS) return std::make_shared<BooleanValue>(false);
-        if(params[0]->getType() == ValueType::PAIR){
-            auto listLHS = static_cast<PairValue*>(params[0].get())->toVector();
-            auto listRHS = static_cast<PairValue*>(params[1].get())->toVector();
-            if(listLHS.size() != listRHS.size()) return std::make_shared<BooleanValue>(false);
-            for(size_t i = 0; i < listLHS.size(); i++){
-                if(!static_cast<BooleanValue*>(equal({listLHS[i], listRHS[i]}, e).get())->getValue()){
-                    return std::make_shared<BooleanValue>(false);
-                }
-            }
-            return std::make_shared<BooleanValue>(true);
-        }
-        else return std::make_shared<BooleanValue>(params[0] == params[1]);
-    }
+ValuePtr equal(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return ValuePtr::boolean(Equality::equal(x, y));
 }
 
-ValuePtr NOT(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
-        throw ArgumentError();
-    if(params[0]->getType()==ValueType::BOOLEAN && !static_cast<BooleanValue*>(params[0].get())->getValue())
-        return std::make_shared<BooleanValue>(true);
-    return std::make_shared<BooleanValue>(false);
+ValuePtr NOT(const ValuePtr& x, EvalEnv&){
+    return ValuePtr::boolean(x.isFalse());
 }
 
-ValuePtr numEq(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
+// Compares two exact integers exactly, and anything else as doubles.
+template <typename Compare>
+static ValuePtr compareNumbers(const ValuePtr& x, const ValuePtr& y, Compare compare){
+    if(!x.isNumber() || !y.isNumber())
         throw LispError("Non-numeric value");
-    double diff = std::abs(static_cast<NumericValue*>(params[0].get())->asNumber() - static_cast<NumericValue*>(params[1].get())->asNumber());
-    return std::make_shared<BooleanValue>(diff < 1e-10);
+    if(x.isInt64() && y.isInt64())
+        return ValuePtr::boolean(compare(x.asInteger(), y.asInteger()));
+    if(x.isExact() && y.isExact())
+        return ValuePtr::boolean(compare(x.asBigInt().compare(y.asBigInt()), 0));
+    return ValuePtr::boolean(compare(x.asNumber(), y.asNumber()));
 }
 
-ValuePtr odd(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
-        throw ArgumentError();
-    if(!params[0]->isNumber())
+ValuePtr numEq(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    if(!x.isNumber() || !y.isNumber())
         throw LispError("Non-numeric value");
-    if(!params[0]->isInteger())
-        throw LispError("Non-integer value");
-    double result = static_cast<NumericValue*>(params[0].get())->asNumber();
-    return std::make_shared<BooleanValue>(static_cast<int>(result) % 2 != 0);  
+    if(x.isInt64() && y.isInt64())
+        return ValuePtr::boolean(x.asInteger() == y.asInteger());
+    if(x.isExact() && y.isExact())
+        return ValuePtr::boolean(x.asBigInt().compare(y.asBigInt()) == 0);
+    double diff = std::abs(x.asNumber() - y.asNumber());
+    return ValuePtr::boolean(diff < 1e-10);
+}
+
+static bool isOdd(const ValuePtr& value){
+    if(value.isInt64())
+        return value.asInteger() % 2 != 0;
+    if(value.isExact())
+        return value.asBigInt().isOdd();
+    return std::fmod(value.asNumber(), 2) != 0;
 }
 
-ValuePtr even(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr odd(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    if(!params[0]->isNumber())
+    if(!params[0].isNumber())
         throw LispError("Non-numeric value");
-    if(!params[0]->isInteger())
+    if(!params[0].isInteger())
         throw LispError("Non-integer value");
-    double result = static_cast<NumericValue*>(params[0].get())->asNumber();
-    return std::make_shared<BooleanValue>(static_cast<int>(result) % 2 == 0);  
+    return ValuePtr::boolean(isOdd(params[0]));  
 }
 
-ValuePtr zero(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr even(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    if(!params[0]->isNumber())
+    if(!params[0].isNumber())
         throw LispError("Non-numeric value");
-    double result = static_cast<NumericValue*>(params[0].get())->asNumber();
-    return std::make_shared<BooleanValue>(result == 0);  
+    if(!params[0].isInteger())
+        throw LispError("Non-integer value");
+    return ValuePtr::boolean(!isOdd(params[0]));  
 }
 
-ValuePtr greater(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
+ValuePtr zero(const ValuePtr& x, EvalEnv&){
+    if(!x.isNumber())
         throw LispError("Non-numeric value");
-    double LHS = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double RHS = static_cast<NumericValue*>(params[1].get())->asNumber();
-    return std::make_shared<BooleanValue>(LHS > RHS);  
+    double result = x.asNumber();
+    return ValuePtr::boolean(result == 0);  
 }
 
-ValuePtr less(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
-        throw LispError("Non-numeric value");
-    double LHS = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double RHS = static_cast<NumericValue*>(params[1].get())->asNumber();
-    return std::make_shared<BooleanValue>(LHS < RHS);  
+ValuePtr greater(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return compareNumbers(x, y, [](auto LHS, auto RHS){return LHS > RHS;});
 }
 
-ValuePtr lessEq(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
-        throw LispError("Non-numeric value");
-    double LHS = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double RHS = static_cast<NumericValue*>(params[1].get())->asNumber();
-    return std::make_shared<BooleanValue>(LHS <= RHS);  
+ValuePtr less(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return compareNumbers(x, y, [](auto LHS, auto RHS){return LHS < RHS;});
 }
 
-ValuePtr greaterEq(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    if(!params[0]->isNumber() || !params[1]->isNumber())
-        throw LispError("Non-numeric value");
-    double LHS = static_cast<NumericValue*>(params[0].get())->asNumber();
-    double RHS = static_cast<NumericValue*>(params[1].get())->asNumber();
-    return std::make_shared<BooleanValue>(LHS >= RHS);  
+ValuePtr lessEq(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return compareNumbers(x, y, [](auto LHS, auto RHS){return LHS <= RHS;});
+}
+
+ValuePtr greaterEq(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return compareNumbers(x, y, [](auto LHS, auto RHS){return LHS >= RHS;});
 }
 
-ValuePtr boolean(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr boolean(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->isBoolean());
+    return ValuePtr::boolean(params[0].isBoolean());
 }
 
-ValuePtr atom(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr atom(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->isAtom());
+    return ValuePtr::boolean(params[0].isAtom());
 }
 
-ValuePtr null(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr null(const ValuePtr& x, EvalEnv&){
+    return ValuePtr::boolean(x.isNil());
+}
+
+ValuePtr number(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->isNil());
-}   
+    return ValuePtr::boolean(params[0].isNumber());
+}
 
-ValuePtr number(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr pair(const ValuePtr& x, EvalEnv&){
+    return ValuePtr::boolean(x.getType() == ValueType::PAIR);
+}
+
+ValuePtr procedure(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->isNumber());
+    return ValuePtr::boolean(params[0].getType() == ValueType::BUILTIN_PROC || params[0].getType() == ValueType::LAMBDA);
 }
 
-ValuePtr pair(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr symbol(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->getType() == ValueType::PAIR);
+    return ValuePtr::boolean(params[0].asSymbol().has_value());
 }
 
-ValuePtr procedure(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
+ValuePtr symbolTableSize(ValueSpan params, EvalEnv&){
+    if(params.size() != 0)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->getType() == ValueType::BUILTIN_PROC || params[0]->getType() == ValueType::LAMBDA);
+    return ValuePtr::integer(static_cast<int64_t>(Symbol::tableSize()));
 }
 
-ValuePtr symbol(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
+ValuePtr gc(ValueSpan params, EvalEnv&){
+    if(params.size() != 0)
+        throw ArgumentError();
+    return ValuePtr::integer(static_cast<int64_t>(Heap::collect()));
+}
+
+ValuePtr gcStats(ValueSpan params, EvalEnv&){
+    if(params.size() != 0)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->asSymbol().has_value());
+    const auto& stats = Heap::stats();
+    std::vector<std::pair<const char*, ValuePtr>> fields{
+        {"heap-objects", ValuePtr::integer(static_cast<int64_t>(Heap::size()))},
+        {"collections", ValuePtr::integer(static_cast<int64_t>(stats.collections))},
+        {"freed", ValuePtr::integer(static_cast<int64_t>(stats.freed))},
+        {"last-pause-ms", ValuePtr::number(stats.lastPauseMs)},
+        {"total-pause-ms", ValuePtr::number(stats.totalPauseMs)},
+        {"max-pause-ms", ValuePtr::number(stats.maxPauseMs)},
+    };
+    ValuePtr result = ValuePtr::nil();
+    for (auto it = fields.rbegin(); it != fields.rend(); ++it) {
+        auto entry = makeValue<PairValue>(makeValue<SymbolValue>(Symbol::intern(it->first)), it->second);
+        result = makeValue<PairValue>(std::move(entry), std::move(result));
+    }
+    return result;
 }
 
-ValuePtr string(const std::vector<ValuePtr>& params, EvalEnv&){
+// Copied before the list is built, so that building it is not counted.
+ValuePtr runtimeStats(ValueSpan params, EvalEnv&){
+    if(params.size() != 0)
+        throw ArgumentError();
+    auto fields = Stats::snapshot();
+    ValuePtr result = ValuePtr::nil();
+    for (auto it = fields.rbegin(); it != fields.rend(); ++it) {
+        auto entry = makeValue<PairValue>(makeValue<SymbolValue>(Symbol::intern(it->first)),
+                                          ValuePtr::integer(static_cast<int64_t>(it->second)));
+        result = makeValue<PairValue>(std::move(entry), std::move(result));
+    }
+    return result;
+}
+
+ValuePtr string(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->getType() == ValueType::STRING);
+    return ValuePtr::boolean(params[0].getType() == ValueType::STRING);
 }
 
-ValuePtr integer(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr integer(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->isInteger());
+    return ValuePtr::boolean(params[0].isInteger());
 }
 
-ValuePtr list(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr list(ValueSpan params, EvalEnv&){
     if(params.size() != 1)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::PAIR){
-        if(params[0]->isNil()) return std::make_shared<BooleanValue>(true);
-        return std::make_shared<BooleanValue>(false);
+    if(params[0].getType() != ValueType::PAIR){
+        if(params[0].isNil()) return ValuePtr::boolean(true);
+        return ValuePtr::boolean(false);
     }
     ValuePtr current = params[0];
-    while (current->getType() == ValueType::PAIR)
+    while (current.getType() == ValueType::PAIR)
         current = static_cast<PairValue*>(current.get())->getCdr();
-    return std::make_shared<BooleanValue>(current->isNil());
+    return ValuePtr::boolean(current.isNil());
 }
 
-ValuePtr append(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr append(ValueSpan params, EvalEnv& e){
     if(params.size() == 0)
-        return std::make_shared<NilValue>();
+        return ValuePtr::nil();
     std::vector<ValuePtr> result;
     for(size_t i = 0; i < params.size(); i++){
         auto islist = list({params[i]}, e);
-        if(!static_cast<BooleanValue*>(islist.get())->getValue())
+        if(!islist.asBoolean())
             throw LispError("Not a list");
-        auto pair = static_cast<PairValue*>(params[i].get());
-        std::vector<ValuePtr> addtion = pair->toVector();
+        std::vector<ValuePtr> addtion = params[i].toVector();
         for(auto& i: addtion)
             result.push_back(i);
     }
     return makelist(result, e);
 }
 
-ValuePtr car(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
-        throw ArgumentError();
-    if(params[0]->getType() != ValueType::PAIR)
+ValuePtr car(const ValuePtr& x, EvalEnv&){
+    if(x.getType() != ValueType::PAIR)
         throw LispError("Not a pair");
-    return static_cast<PairValue*>(params[0].get())->getCar();
+    return static_cast<PairValue*>(x.get())->getCar();
 }
 
-ValuePtr cdr(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 1)
-        throw ArgumentError();
-    if(params[0]->getType() != ValueType::PAIR){
+ValuePtr cdr(const ValuePtr& x, EvalEnv&){
+    if(x.getType() != ValueType::PAIR){
         throw LispError("Not a pair");
     }
-    return static_cast<PairValue*>(params[0].get())->getCdr();
+    return static_cast<PairValue*>(x.get())->getCdr();
 }
 
-ValuePtr cons(const std::vector<ValuePtr>& params, EvalEnv&){
-    if(params.size() != 2)
-        throw ArgumentError();
-    return std::make_shared<PairValue>(params[0], params[1]);
+ValuePtr cons(const ValuePtr& x, const ValuePtr& y, EvalEnv&){
+    return makeValue<PairValue>(x, y);
 }
 
-ValuePtr length(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr length(ValueSpan params, EvalEnv& e){
     if(params.size() != 1)
         throw ArgumentError();
     auto isList = list({params[0]}, e);
-    if(!static_cast<BooleanValue*>(isList.get())->getValue())
+    if(!isList.asBoolean())
         throw LispError("Not a list");
     ValuePtr current = params[0];
-    int result = 0;
-    while (current->getType() == ValueType::PAIR){
+    int64_t result = 0;
+    while (current.getType() == ValueType::PAIR){
         result++;
         current = static_cast<PairValue*>(current.get())->getCdr();
     }
-    return std::make_shared<NumericValue>(result);
+    return ValuePtr::integer(result);
 }
 
-ValuePtr makelist(const std::vector<ValuePtr>& params, EvalEnv& e){
-    if(params.size() == 0)
-        return std::make_shared<NilValue>();
-    ValuePtr cdr = makelist({params.begin() + 1, params.end()}, e);
-    return std::make_shared<PairValue>(params[0], cdr);
+// Built front to back, so consecutive cells are allocated next to each
+// other in the order a traversal visits them.
+ValuePtr makelist(ValueSpan params, EvalEnv&){
+    ValuePtr head = ValuePtr::nil();
+    PairValue* last = nullptr;
+    for(auto& i: params){
+        auto cell = makeValue<PairValue>(i, ValuePtr::nil());
+        auto next = static_cast<PairValue*>(cell.get());
+        if(last)
+            last->setCdr(std::move(cell));
+        else
+            head = std::move(cell);
+        last = next;
+    }
+    return head;
 }
 
-ValuePtr map(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr map(ValueSpan params, EvalEnv& e){
     if(params.size() != 2)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::BUILTIN_PROC && params[0]->getType() != ValueType::LAMBDA)
+    if(params[0].getType() != ValueType::BUILTIN_PROC && params[0].getType() != ValueType::LAMBDA)
         throw LispError("Not a procedure");
     auto islist = list({params[1]}, e);
-    if(!static_cast<BooleanValue*>(islist.get())->getValue())
+    if(!islist.asBoolean())
         throw LispError("Not a list");
-    if(params[0]->getType() == ValueType::BUILTIN_PROC){
-        auto func = static_cast<BuiltinProcValue*>(params[0].get())->getFunc();
-        std::vector<ValuePtr> result = static_cast<PairValue*>(params[1].get())->toVector();
+    if(params[0].getType() == ValueType::BUILTIN_PROC){
+        auto func = static_cast<BuiltinProcValue*>(params[0].get());
+        std::vector<ValuePtr> result = params[1].toVector();
         std::vector<ValuePtr> newlist;
         for(auto& i: result)
-            newlist.push_back(func({i}, e));
+            newlist.push_back(func->call(i, e));
         return makelist(newlist, e);
     }
-    if(params[0]->getType() == ValueType::LAMBDA){
+    if(params[0].getType() == ValueType::LAMBDA){
         auto lambda = static_cast<LambdaValue*>(params[0].get());
-        std::vector<ValuePtr> result = static_cast<PairValue*>(params[1].get())->toVector();
+        std::vector<ValuePtr> result = params[1].toVector();
         std::vector<ValuePtr> newlist;
         for(auto& i: result)
             newlist.push_back(lambda->apply({i}));
         return makelist(newlist, e);
     }
-    return std::make_shared<NilValue>();    
+    return ValuePtr::nil();    
 }
 
-ValuePtr filter(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr filter(ValueSpan params, EvalEnv& e){
     if(params.size() != 2)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::BUILTIN_PROC && params[0]->getType() != ValueType::LAMBDA)
+    if(params[0].getType() != ValueType::BUILTIN_PROC && params[0].getType() != ValueType::LAMBDA)
         throw LispError("Not a procedure");
     auto islist = list({params[1]}, e);
-    if(!static_cast<BooleanValue*>(islist.get())->getValue())
+    if(!islist.asBoolean())
         throw LispError("Not a list");
-    if(params[0]->getType() == ValueType::BUILTIN_PROC){
-        auto func = static_cast<BuiltinProcValue*>(params[0].get())->getFunc();
-        std::vector<ValuePtr> result = static_cast<PairValue*>(params[1].get())->toVector();
+    if(params[0].getType() == ValueType::BUILTIN_PROC){
+        auto func = static_cast<BuiltinProcValue*>(params[0].get());
+        std::vector<ValuePtr> result = params[1].toVector();
         std::vector<ValuePtr> newlist;
         for(auto& i: result){
-            if((func({i}, e))->isBoolean() && !static_cast<BooleanValue*>(func({i}, e).get())->getValue()) continue;
+            if(func->call(i, e).isFalse()) continue;
             else newlist.push_back(i);
         }
         return makelist(newlist, e);
     }
-    if(params[0]->getType() == ValueType::LAMBDA){
+    if(params[0].getType() == ValueType::LAMBDA){
         auto lambda = static_cast<LambdaValue*>(params[0].get());
-        std::vector<ValuePtr> result = static_cast<PairValue*>(params[1].get())->toVector();
+        std::vector<ValuePtr> result = params[1].toVector();
         std::vector<ValuePtr> newlist;
         for(auto& i: result){
-            if((lambda->apply({i}))->isBoolean() && !static_cast<BooleanValue*>(lambda->apply({i}).get())->getValue()) continue;
+            if(lambda->apply({i}).isFalse()) continue;
             else newlist.push_back(i);
         }
         return makelist(newlist, e);
     }
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr reduce(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr reduce(ValueSpan params, EvalEnv& e){
     if(params.size() != 2)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::BUILTIN_PROC && params[0]->getType() != ValueType::LAMBDA)
+    if(params[0].getType() != ValueType::BUILTIN_PROC && params[0].getType() != ValueType::LAMBDA)
         throw LispError("Not a procedure");
     auto islist = list({params[1]}, e);
-    if(!static_cast<BooleanValue*>(islist.get())->getValue())
+    if(!islist.asBoolean())
         throw LispError("Not a list");
-    if(params[0]->getType() == ValueType::BUILTIN_PROC){
-        auto proc = static_cast<BuiltinProcValue*>(params[0].get())->getFunc();
-        int len = static_cast<NumericValue*>(length({params[1]}, e).get())->asNumber();
+    if(params[0].getType() == ValueType::BUILTIN_PROC){
+        auto proc = static_cast<BuiltinProcValue*>(params[0].get());
+        auto len = length({params[1]}, e).asInteger();
         if(len==1) return static_cast<PairValue*>(params[1].get())->getCar();
-        else return proc({car({params[1]}, e), reduce({params[0], cdr({params[1]}, e)}, e)}, e);
+        else return proc->call(car(params[1], e), reduce({params[0], cdr(params[1], e)}, e), e);
     }
-    if(params[0]->getType() == ValueType::LAMBDA){
+    if(params[0].getType() == ValueType::LAMBDA){
         auto lambda = static_cast<LambdaValue*>(params[0].get());
-        int len = static_cast<NumericValue*>(length({params[1]}, e).get())->asNumber();
+        auto len = length({params[1]}, e).asInteger();
         if(len==1) return static_cast<PairValue*>(params[1].get())->getCar();
-        else return lambda->apply({car({params[1]}, e), reduce({params[0], cdr({params[1]}, e)}, e)});
+        else return lambda->apply({car(params[1], e), reduce({params[0], cdr(params[1], e)}, e)});
     }
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr setCdr(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr setCdr(ValueSpan params, EvalEnv&){
     if(params.size() != 2)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::PAIR)
+    if(params[0].getType() != ValueType::PAIR)
         throw LispError("Not a pair");
     static_cast<PairValue*>(params[0].get())->setCdr(params[1]);
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr setCar(const std::vector<ValuePtr>& params, EvalEnv&){
+ValuePtr setCar(ValueSpan params, EvalEnv&){
     if(params.size() != 2)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::PAIR)
+    if(params[0].getType() != ValueType::PAIR)
         throw LispError("Not a pair");
     static_cast<PairValue*>(params[0].get())->setCar(params[1]);
-    return std::make_shared<NilValue>();
+    return ValuePtr::nil();
 }
 
-ValuePtr promise(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr promise(ValueSpan params, EvalEnv& e){
     if(params.size() != 1)
         throw ArgumentError();
-    return std::make_shared<BooleanValue>(params[0]->getType() == ValueType::PROMISE);
+    return ValuePtr::boolean(params[0].getType() == ValueType::PROMISE);
 }
 
-ValuePtr force(const std::vector<ValuePtr>& params, EvalEnv& e){
+ValuePtr force(ValueSpan params, EvalEnv& e){
     if(params.size() != 1)
         throw ArgumentError();
-    if(params[0]->getType() != ValueType::PROMISE)
+    if(params[0].getType() != ValueType::PROMISE)
         throw LispError("Not a promise");
     return static_cast<PromiseValue*>(params[0].get())->force();
 }
 
+static F64VectorValue& asF64Vector(const ValuePtr& value){
+    if(value.getType() != ValueType::F64VECTOR)
+        throw LispError("Not an f64vector");
+    return *static_cast<F64VectorValue*>(value.get());
+}
+
+static size_t asIndex(const ValuePtr& value, size_t size){
+    if(!value.isInt64() || value.asInteger() < 0 || static_cast<uint64_t>(value.asInteger()) >= size)
+        throw LispError("Index out of range");
+    return static_cast<size_t>(value.asInteger());
+}
+
+static double asElement(const ValuePtr& value){
+    if(!value.isNumber())
+        throw LispError("Non-numeric value");
+    return value.asNumber();
+}
+
+ValuePtr f64vector(ValueSpan params, EvalEnv&){
+    std::vector<double> elements;
+    elements.reserve(params.size());
+    for(const auto& i: params)
+        elements.push_back(asElement(i));
+    return makeValue<F64VectorValue>(std::move(elements));
+}
+
+ValuePtr makeF64vector(ValueSpan params, EvalEnv&){
+    if(params.size() != 1 && params.size() != 2)
+        throw ArgumentError();
+    if(!params[0].isInt64() || params[0].asInteger() < 0)
+        throw LispError("Invalid length");
+    double fill = params.size() == 2 ? asElement(params[1]) : 0;
+    return makeValue<F64VectorValue>(std::vector<double>(static_cast<size_t>(params[0].asInteger()), fill));
+}
+
+ValuePtr isF64vector(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::boolean(params[0].getType() == ValueType::F64VECTOR);
+}
+
+ValuePtr f64vectorLength(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::integer(static_cast<int64_t>(asF64Vector(params[0]).getElements().size()));
+}
+
+ValuePtr f64vectorRef(ValueSpan params, EvalEnv&){
+    if(params.size() != 2)
+        throw ArgumentError();
+    const auto& elements = asF64Vector(params[0]).getElements();
+    return ValuePtr::number(elements[asIndex(params[1], elements.size())]);
+}
+
+ValuePtr f64vectorSet(ValueSpan params, EvalEnv&){
+    if(params.size() != 3)
+        throw ArgumentError();
+    auto& elements = asF64Vector(params[0]).getElements();
+    elements[asIndex(params[1], elements.size())] = asElement(params[2]);
+    return ValuePtr::nil();
+}
+
+ValuePtr listToF64vector(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1)
+        throw ArgumentError();
+    if(!list({params[0]}, e).asBoolean())
+        throw LispError("Not a list");
+    return f64vector(params[0].toVector(), e);
+}
+
+ValuePtr f64vectorToList(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1)
+        throw ArgumentError();
+    std::vector<ValuePtr> elements;
+    for(double i: asF64Vector(params[0]).getElements())
+        elements.push_back(ValuePtr::number(i));
+    return makelist(elements, e);
+}
+
+ValuePtr f64vectorSum(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    const auto& x = asF64Vector(params[0]).getElements();
+    return ValuePtr::number(F64Kernels::sum(x.data(), x.size()));
+}
+
+// The two vectors of an element-wise operation, which must match in length.
+static std::pair<const std::vector<double>*, const std::vector<double>*> f64vectorPair(ValueSpan params){
+    if(params.size() != 2)
+        throw ArgumentError();
+    const auto& x = asF64Vector(params[0]).getElements();
+    const auto& y = asF64Vector(params[1]).getElements();
+    if(x.size() != y.size())
+        throw LispError("f64vector lengths differ");
+    return {&x, &y};
+}
+
+ValuePtr f64vectorDot(ValueSpan params, EvalEnv&){
+    auto [x, y] = f64vectorPair(params);
+    return ValuePtr::number(F64Kernels::dot(x->data(), y->data(), x->size()));
+}
+
+ValuePtr f64vectorAdd(ValueSpan params, EvalEnv&){
+    auto [x, y] = f64vectorPair(params);
+    std::vector<double> result(x->size());
+    F64Kernels::add(x->data(), y->data(), result.data(), result.size());
+    return makeValue<F64VectorValue>(std::move(result));
+}
+
+ValuePtr f64vectorMul(ValueSpan params, EvalEnv&){
+    auto [x, y] = f64vectorPair(params);
+    std::vector<double> result(x->size());
+    F64Kernels::mul(x->data(), y->data(), result.data(), result.size());
+    return makeValue<F64VectorValue>(std::move(result));
+}
+
+ValuePtr f64vectorScale(ValueSpan params, EvalEnv&){
+    if(params.size() != 2)
+        throw ArgumentError();
+    const auto& x = asF64Vector(params[0]).getElements();
+    std::vector<double> result(x.size());
+    F64Kernels::scale(x.data(), asElement(params[1]), result.data(), result.size());
+    return makeValue<F64VectorValue>(std::move(result));
+}
+
+ValuePtr f64vectorMin(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    const auto& x = asF64Vector(params[0]).getElements();
+    if(x.empty())
+        throw LispError("Empty f64vector");
+    return ValuePtr::number(F64Kernels::min(x.data(), x.size()));
+}
+
+ValuePtr f64vectorMax(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    const auto& x = asF64Vector(params[0]).getElements();
+    if(x.empty())
+        throw LispError("Empty f64vector");
+    return ValuePtr::number(F64Kernels::max(x.data(), x.size()));
+}
+
+static VectorValue& asVector(const ValuePtr& value){
+    if(value.getType() != ValueType::VECTOR)
+        throw LispError("Not a vector");
+    return *static_cast<VectorValue*>(value.get());
+}
+
+ValuePtr vector(ValueSpan params, EvalEnv&){
+    return makeValue<VectorValue>(std::vector<ValuePtr>(params.begin(), params.end()));
+}
+
+ValuePtr makeVector(ValueSpan params, EvalEnv&){
+    if(params.size() != 1 && params.size() != 2)
+        throw ArgumentError();
+    if(!params[0].isInt64() || params[0].asInteger() < 0)
+        throw LispError("Invalid length");
+    ValuePtr fill = params.size() == 2 ? params[1] : ValuePtr::integer(0);
+    return makeValue<VectorValue>(std::vector<ValuePtr>(static_cast<size_t>(params[0].asInteger()), fill));
+}
+
+ValuePtr isVector(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::boolean(params[0].getType() == ValueType::VECTOR);
+}
+
+ValuePtr vectorLength(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::integer(static_cast<int64_t>(asVector(params[0]).getElements().size()));
+}
+
+ValuePtr vectorRef(const ValuePtr& v, const ValuePtr& k, EvalEnv&){
+    const auto& elements = asVector(v).getElements();
+    return elements[asIndex(k, elements.size())];
+}
+
+ValuePtr vectorSet(ValueSpan params, EvalEnv&){
+    if(params.size() != 3)
+        throw ArgumentError();
+    auto& elements = asVector(params[0]).getElements();
+    elements[asIndex(params[1], elements.size())] = params[2];
+    return ValuePtr::nil();
+}
+
+ValuePtr vectorFill(ValueSpan params, EvalEnv&){
+    if(params.size() != 2)
+        throw ArgumentError();
+    auto& elements = asVector(params[0]).getElements();
+    std::fill(elements.begin(), elements.end(), params[1]);
+    return ValuePtr::nil();
+}
+
+ValuePtr listToVector(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1)
+        throw ArgumentError();
+    if(!list({params[0]}, e).asBoolean())
+        throw LispError("Not a list");
+    return makeValue<VectorValue>(params[0].toVector());
+}
+
+ValuePtr vectorToList(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return makelist(asVector(params[0]).getElements(), e);
+}
+
+static HashTableValue& asHashTable(const ValuePtr& value){
+    if(value.getType() != ValueType::HASH_TABLE)
+        throw LispError("Not a hash table");
+    return *static_cast<HashTableValue*>(value.get());
+}
+
+// The optional argument names the equivalence keys are compared by, as
+// the symbol eq? or equal? or as that procedure itself; equal? by default.
+ValuePtr makeHashTable(ValueSpan params, EvalEnv&){
+    if(params.size() > 1)
+        throw ArgumentError();
+    auto kind = HashTableValue::Kind::EQUAL;
+    if(params.size() == 1){
+        std::optional<Symbol> name = params[0].asSymbol();
+        if(params[0].getType() == ValueType::BUILTIN_PROC)
+            name = static_cast<BuiltinProcValue*>(params[0].get())->getName();
+        if(name && name->str() == "eq?")
+            kind = HashTableValue::Kind::EQ;
+        else if(!name || name->str() != "equal?")
+            throw LispError("Hash tables compare keys by eq? or equal?");
+    }
+    return makeValue<HashTableValue>(kind);
+}
+
+ValuePtr isHashTable(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::boolean(params[0].getType() == ValueType::HASH_TABLE);
+}
+
+ValuePtr hashRef(ValueSpan params, EvalEnv&){
+    if(params.size() != 2 && params.size() != 3)
+        throw ArgumentError();
+    if(auto value = asHashTable(params[0]).find(params[1]))
+        return *value;
+    if(params.size() == 3)
+        return params[2];
+    throw LispError("No value for key " + params[1].toString());
+}
+
+ValuePtr hashSet(ValueSpan params, EvalEnv&){
+    if(params.size() != 3)
+        throw ArgumentError();
+    asHashTable(params[0]).set(params[1], params[2]);
+    return ValuePtr::nil();
+}
+
+ValuePtr hashRemove(ValueSpan params, EvalEnv&){
+    if(params.size() != 2)
+        throw ArgumentError();
+    return ValuePtr::boolean(asHashTable(params[0]).remove(params[1]));
+}
+
+ValuePtr hashCount(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::integer(static_cast<int64_t>(asHashTable(params[0]).size()));
+}
+
+ValuePtr hashKeys(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return makelist(asHashTable(params[0]).keys(), e);
+}
+
+static const StringValue& asString(const ValuePtr& value){
+    if(value.getType() != ValueType::STRING)
+        throw LispError("Not a string");
+    return *static_cast<StringValue*>(value.get());
+}
+
+// Concatenates parts, separated by separator, into a buffer sized once.
+static ValuePtr joinStrings(ValueSpan parts, std::string_view separator){
+    size_t size = parts.empty() ? 0 : separator.size() * (parts.size() - 1);
+    for(const auto& i: parts)
+        size += asString(i).size();
+    std::string result;
+    result.reserve(size);
+    for(size_t i = 0; i < parts.size(); i++){
+        if(i > 0)
+            result += separator;
+        result += asString(parts[i]).getValue();
+    }
+    return makeValue<StringValue>(std::move(result));
+}
+
+ValuePtr stringAppend(ValueSpan params, EvalEnv&){
+    // Strings are immutable, so a single one can be returned as it is.
+    if(params.size() == 1 && params[0].getType() == ValueType::STRING)
+        return params[0];
+    return joinStrings(params, "");
+}
+
+ValuePtr stringJoin(ValueSpan params, EvalEnv& e){
+    if(params.size() != 1 && params.size() != 2)
+        throw ArgumentError();
+    if(!list({params[0]}, e).asBoolean())
+        throw LispError("Not a list");
+    std::string_view separator = params.size() == 2 ? asString(params[1]).getValue() : " ";
+    return joinStrings(params[0].toVector(), separator);
+}
+
+ValuePtr substring(ValueSpan params, EvalEnv&){
+    if(params.size() != 2 && params.size() != 3)
+        throw ArgumentError();
+    const auto& string = asString(params[0]);
+    size_t end = params.size() == 3 ? asIndex(params[2], string.size() + 1) : string.size();
+    size_t start = asIndex(params[1], end + 1);
+    if(start == 0 && end == string.size())
+        return params[0];
+    return string.substring(start, end);
+}
+
+ValuePtr stringLength(const ValuePtr& x, EvalEnv&){
+    return ValuePtr::integer(static_cast<int64_t>(asString(x).size()));
+}
+
+// There is no character type, so the character is a string of length one.
+ValuePtr stringRef(const ValuePtr& x, const ValuePtr& k, EvalEnv&){
+    const auto& string = asString(x);
+    size_t index = asIndex(k, string.size());
+    return string.substring(index, index + 1);
+}
+
+template <typename Compare>
+static ValuePtr compareStrings(ValueSpan params, Compare compare){
+    if(params.empty())
+        throw ArgumentError();
+    std::string_view previous = asString(params[0]).getValue();
+    bool result = true;
+    for(size_t i = 1; i < params.size(); i++){
+        std::string_view next = asString(params[i]).getValue();
+        result = result && compare(previous, next);
+        previous = next;
+    }
+    return ValuePtr::boolean(result);
+}
+
+ValuePtr stringEq(ValueSpan params, EvalEnv&){
+    return compareStrings(params, std::equal_to<>());
+}
+
+ValuePtr stringLess(ValueSpan params, EvalEnv&){
+    return compareStrings(params, std::less<>());
+}
+
+ValuePtr stringToSymbol(const ValuePtr& x, EvalEnv&){
+    return makeValue<SymbolValue>(Symbol::intern(asString(x).getValue()));
+}
+
+ValuePtr numberToString(const ValuePtr& x, EvalEnv&){
+    if(!x.isNumber())
+        throw LispError("Non-numeric value");
+    return makeValue<StringValue>(x.toString());
+}
+
+// Reads the string as a numeric literal; #f when it is anything else.
+ValuePtr stringToNumber(const ValuePtr& x, EvalEnv&){
+    std::deque<TokenPtr> tokens;
+    try{
+        tokens = Tokenizer::tokenize(std::string(asString(x).getValue()));
+    }catch(const SyntaxError&){
+        return ValuePtr::boolean(false);
+    }
+    if(tokens.size() != 1 || tokens.front()->getType() != TokenType::NUMERIC_LITERAL)
+        return ValuePtr::boolean(false);
+    return Parser(std::move(tokens)).parse();
+}
+
+static const PersistentMapValue& asPersistent(const ValuePtr& value, ValueType type){
+    if(value.getType() != type)
+        throw LispError(type == ValueType::PMAP ? "Not a pmap" : "Not a pset");
+    return *static_cast<PersistentMapValue*>(value.get());
+}
+
+// Keys alternate with their values.
+ValuePtr pmap(ValueSpan params, EvalEnv&){
+    if(params.size() % 2 != 0)
+        throw ArgumentError();
+    ValuePtr result = makeValue<PersistentMapValue>(ValueType::PMAP);
+    for(size_t i = 0; i < params.size(); i += 2)
+        result = static_cast<PersistentMapValue*>(result.get())->assoc(params[i], params[i + 1]);
+    return result;
+}
+
+ValuePtr isPmap(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::boolean(params[0].getType() == ValueType::PMAP);
+}
+
+ValuePtr pmapAssoc(ValueSpan params, EvalEnv&){
+    if(params.size() != 3)
+        throw ArgumentError();
+    return asPersistent(params[0], ValueType::PMAP).assoc(params[1], params[2]);
+}
+
+ValuePtr pmapDissoc(const ValuePtr& map, const ValuePtr& key, EvalEnv&){
+    return asPersistent(map, ValueType::PMAP).dissoc(key);
+}
+
+ValuePtr pmapGet(ValueSpan params, EvalEnv&){
+    if(params.size() != 2 && params.size() != 3)
+        throw ArgumentError();
+    if(auto value = asPersistent(params[0], ValueType::PMAP).find(params[1]))
+        return *value;
+    if(params.size() == 3)
+        return params[2];
+    throw LispError("No value for key " + params[1].toString());
+}
+
+ValuePtr pmapCount(const ValuePtr& map, EvalEnv&){
+    return ValuePtr::integer(static_cast<int64_t>(asPersistent(map, ValueType::PMAP).size()));
+}
+
+ValuePtr pmapKeys(const ValuePtr& map, EvalEnv& e){
+    std::vector<ValuePtr> keys;
+    asPersistent(map, ValueType::PMAP).forEach([&](const HamtEntry& entry){
+        keys.push_back(entry.key);
+    });
+    return makelist(keys, e);
+}
+
+ValuePtr pset(ValueSpan params, EvalEnv&){
+    ValuePtr result = makeValue<PersistentMapValue>(ValueType::PSET);
+    for(const auto& i: params)
+        result = static_cast<PersistentMapValue*>(result.get())->assoc(i, ValuePtr::boolean(true));
+    return result;
+}
+
+ValuePtr isPset(ValueSpan params, EvalEnv&){
+    if(params.size() != 1)
+        throw ArgumentError();
+    return ValuePtr::boolean(params[0].getType() == ValueType::PSET);
+}
+
+ValuePtr psetAdd(const ValuePtr& set, const ValuePtr& x, EvalEnv&){
+    return asPersistent(set, ValueType::PSET).assoc(x, ValuePtr::boolean(true));
+}
+
+ValuePtr psetRemove(const ValuePtr& set, const ValuePtr& x, EvalEnv&){
+    return asPersistent(set, ValueType::PSET).dissoc(x);
+}
+
+ValuePtr psetContains(const ValuePtr& set, const ValuePtr& x, EvalEnv&){
+    return ValuePtr::boolean(asPersistent(set, ValueType::PSET).find(x) != nullptr);
+}
+
+ValuePtr psetCount(const ValuePtr& set, EvalEnv&){
+    return ValuePtr::integer(static_cast<int64_t>(asPersistent(set, ValueType::PSET).size()));
+}
+
+ValuePtr psetToList(const ValuePtr& set, EvalEnv& e){
+    std::vector<ValuePtr> elements;
+    asPersistent(set, ValueType::PSET).forEach([&](const HamtEntry& entry){
+        elements.push_back(entry.key);
+    });
+    return makelist(elements, e);
+}
+
+// Builtins taking exactly one or two arguments are written against the
+// fixed-arity signatures; their general entry point checks the count and
+// forwards.
+template <BuiltinUnaryType* f>
+static ValuePtr unary(){
+    return makeValue<BuiltinProcValue>([](ValueSpan params, EvalEnv& e){
+        if(params.size() != 1)
+            throw ArgumentError();
+        return f(params[0], e);
+    }, f);
+}
+
+template <BuiltinBinaryType* f>
+static ValuePtr binary(){
+    return makeValue<BuiltinProcValue>([](ValueSpan params, EvalEnv& e){
+        if(params.size() != 2)
+            throw ArgumentError();
+        return f(params[0], params[1], e);
+    }, nullptr, f);
+}
+
 extern std::unordered_map<std::string, ValuePtr> BUILTIN{
-    {"apply", std::make_shared<BuiltinProcValue>(apply)},
-    {"display", std::make_shared<BuiltinProcValue>(display)},
-    {"displayln", std::make_shared<BuiltinProcValue>(displayln)},
-    {"print", std::make_shared<BuiltinProcValue>(printer)},
-    {"newline", std::make_shared<BuiltinProcValue>(newline)},
-    {"error", std::make_shared<BuiltinProcValue>(Error)},
-    {"eval", std::make_shared<BuiltinProcValue>(Eval)},
-    {"exit", std::make_shared<BuiltinProcValue>(Exit)},
-    {"+", std::make_shared<BuiltinProcValue>(add)},
-    {"-", std::make_shared<BuiltinProcValue>(sub)},
-    {"*", std::make_shared<BuiltinProcValue>(mul)},
-    {"/", std::make_shared<BuiltinProcValue>(divide)},
-    {"abs", std::make_shared<BuiltinProcValue>(ABS)},
-    {"quotient", std::make_shared<BuiltinProcValue>(quotient)},
-    {"remainder", std::make_shared<BuiltinProcValue>(Remainder)},
-    {"equal?", std::make_shared<BuiltinProcValue>(equal)},
-    {"eq?", std::make_shared<BuiltinProcValue>(eq)},
-    {"not", std::make_shared<BuiltinProcValue>(NOT)},
-    {"odd?", std::make_shared<BuiltinProcValue>(odd)},
-    {"even?", std::make_shared<BuiltinProcValue>(even)},
-    {"zero?", std::make_shared<BuiltinProcValue>(zero)},
-    {"<", std::make_shared<BuiltinProcValue>(less)},
-    {">", std::make_shared<BuiltinProcValue>(greater)},
-    {"=", std::make_shared<BuiltinProcValue>(numEq)},
-    {"<=", std::make_shared<BuiltinProcValue>(lessEq)},
-    {">=", std::make_shared<BuiltinProcValue>(greaterEq)},
-    {"expt", std::make_shared<BuiltinProcValue>(expt)},
-    {"modulo", std::make_shared<BuiltinProcValue>(modulo)},
-    {"atom?", std::make_shared<BuiltinProcValue>(atom)},
-    {"boolean?", std::make_shared<BuiltinProcValue>(boolean)},
-    {"number?", std::make_shared<BuiltinProcValue>(number)},
-    {"pair?", std::make_shared<BuiltinProcValue>(pair)},
-    {"procedure?", std::make_shared<BuiltinProcValue>(procedure)},
-    {"symbol?", std::make_shared<BuiltinProcValue>(symbol)},
-    {"null?", std::make_shared<BuiltinProcValue>(null)},
-    {"string?", std::make_shared<BuiltinProcValue>(string)},
-    {"integer?", std::make_shared<BuiltinProcValue>(integer)},
-    {"list?", std::make_shared<BuiltinProcValue>(list)},
-    {"append", std::make_shared<BuiltinProcValue>(append)},
-    {"cons", std::make_shared<BuiltinProcValue>(cons)},
-    {"car", std::make_shared<BuiltinProcValue>(car)},
-    {"cdr", std::make_shared<BuiltinProcValue>(cdr)},
-    {"length", std::make_shared<BuiltinProcValue>(length)},
-    {"list", std::make_shared<BuiltinProcValue>(makelist)},
-    {"map", std::make_shared<BuiltinProcValue>(map)},
-    {"filter", std::make_shared<BuiltinProcValue>(filter)},
-    {"reduce", std::make_shared<BuiltinProcValue>(reduce)},
-    {"set-cdr!", std::make_shared<BuiltinProcValue>(setCdr)},
-    {"set-car!", std::make_shared<BuiltinProcValue>(setCar)},
-    {"promise?", std::make_shared<BuiltinProcValue>(promise)},
-    {"force", std::make_shared<BuiltinProcValue>(force)}
+    {"apply", makeValue<BuiltinProcValue>(apply)},
+    {"display", makeValue<BuiltinProcValue>(display)},
+    {"displayln", makeValue<BuiltinProcValue>(displayln)},
+    {"print", makeValue<BuiltinProcValue>(printer)},
+    {"newline", makeValue<BuiltinProcValue>(newline)},
+    {"error", makeValue<BuiltinProcValue>(Error)},
+    {"eval", makeValue<BuiltinProcValue>(Eval)},
+    {"exit", makeValue<BuiltinProcValue>(Exit)},
+    {"+", makeValue<BuiltinProcValue>(add, nullptr, add2)},
+    {"-", makeValue<BuiltinProcValue>(sub, nullptr, sub2)},
+    {"*", makeValue<BuiltinProcValue>(mul, nullptr, mul2)},
+    {"/", makeValue<BuiltinProcValue>(divide)},
+    {"abs", makeValue<BuiltinProcValue>(ABS)},
+    {"quotient", binary<quotient>()},
+    {"remainder", binary<Remainder>()},
+    {"equal?", binary<equal>()},
+    {"eq?", binary<eq>()},
+    {"not", unary<NOT>()},
+    {"odd?", makeValue<BuiltinProcValue>(odd)},
+    {"even?", makeValue<BuiltinProcValue>(even)},
+    {"zero?", unary<zero>()},
+    {"<", binary<less>()},
+    {">", binary<greater>()},
+    {"=", binary<numEq>()},
+    {"<=", binary<lessEq>()},
+    {">=", binary<greaterEq>()},
+    {"expt", makeValue<BuiltinProcValue>(expt)},
+    {"modulo", binary<modulo>()},
+    {"atom?", makeValue<BuiltinProcValue>(atom)},
+    {"boolean?", makeValue<BuiltinProcValue>(boolean)},
+    {"number?", makeValue<BuiltinProcValue>(number)},
+    {"pair?", unary<pair>()},
+    {"procedure?", makeValue<BuiltinProcValue>(procedure)},
+    {"symbol?", makeValue<BuiltinProcValue>(symbol)},
+    {"symbol-table-size", makeValue<BuiltinProcValue>(symbolTableSize)},
+    {"gc", makeValue<BuiltinProcValue>(gc)},
+    {"gc-stats", makeValue<BuiltinProcValue>(gcStats)},
+    {"runtime-stats", makeValue<BuiltinProcValue>(runtimeStats)},
+    {"null?", unary<null>()},
+    {"string?", makeValue<BuiltinProcValue>(string)},
+    {"integer?", makeValue<BuiltinProcValue>(integer)},
+    {"list?", makeValue<BuiltinProcValue>(list)},
+    {"append", makeValue<BuiltinProcValue>(append)},
+    {"cons", binary<cons>()},
+    {"car", unary<car>()},
+    {"cdr", unary<cdr>()},
+    {"length", makeValue<BuiltinProcValue>(length)},
+    {"list", makeValue<BuiltinProcValue>(makelist)},
+    {"map", makeValue<BuiltinProcValue>(map)},
+    {"filter", makeValue<BuiltinProcValue>(filter)},
+    {"reduce", makeValue<BuiltinProcValue>(reduce)},
+    {"set-cdr!", makeValue<BuiltinProcValue>(setCdr)},
+    {"set-car!", makeValue<BuiltinProcValue>(setCar)},
+    {"promise?", makeValue<BuiltinProcValue>(promise)},
+    {"force", makeValue<BuiltinProcValue>(force)},
+    {"f64vector", makeValue<BuiltinProcValue>(f64vector)},
+    {"make-f64vector", makeValue<BuiltinProcValue>(makeF64vector)},
+    {"f64vector?", makeValue<BuiltinProcValue>(isF64vector)},
+    {"f64vector-length", makeValue<BuiltinProcValue>(f64vectorLength)},
+    {"f64vector-ref", makeValue<BuiltinProcValue>(f64vectorRef)},
+    {"f64vector-set!", makeValue<BuiltinProcValue>(f64vectorSet)},
+    {"list->f64vector", makeValue<BuiltinProcValue>(listToF64vector)},
+    {"f64vector->list", makeValue<BuiltinProcValue>(f64vectorToList)},
+    {"f64vector-sum", makeValue<BuiltinProcValue>(f64vectorSum)},
+    {"f64vector-dot", makeValue<BuiltinProcValue>(f64vectorDot)},
+    {"f64vector+", makeValue<BuiltinProcValue>(f64vectorAdd)},
+    {"f64vector*", makeValue<BuiltinProcValue>(f64vectorMul)},
+    {"f64vector-scale", makeValue<BuiltinProcValue>(f64vectorScale)},
+    {"f64vector-min", makeValue<BuiltinProcValue>(f64vectorMin)},
+    {"f64vector-max", makeValue<BuiltinProcValue>(f64vectorMax)},
+    {"vector", makeValue<BuiltinProcValue>(vector)},
+    {"make-vector", makeValue<BuiltinProcValue>(makeVector)},
+    {"vector?", makeValue<BuiltinProcValue>(isVector)},
+    {"vector-length", makeValue<BuiltinProcValue>(vectorLength)},
+    {"vector-ref", binary<vectorRef>()},
+    {"vector-set!", makeValue<BuiltinProcValue>(vectorSet)},
+    {"vector-fill!", makeValue<BuiltinProcValue>(vectorFill)},
+    {"list->vector", makeValue<BuiltinProcValue>(listToVector)},
+    {"vector->list", makeValue<BuiltinProcValue>(vectorToList)},
+    {"make-hash-table", makeValue<BuiltinProcValue>(makeHashTable)},
+    {"hash-table?", makeValue<BuiltinProcValue>(isHashTable)},
+    {"hash-ref", makeValue<BuiltinProcValue>(hashRef)},
+    {"hash-set!", makeValue<BuiltinProcValue>(hashSet)},
+    {"hash-remove!", makeValue<BuiltinProcValue>(hashRemove)},
+    {"hash-count", makeValue<BuiltinProcValue>(hashCount)},
+    {"hash-keys", makeValue<BuiltinProcValue>(hashKeys)},
+    {"string-append", makeValue<BuiltinProcValue>(stringAppend)},
+    {"string-join", makeValue<BuiltinProcValue>(stringJoin)},
+    {"substring", makeValue<BuiltinProcValue>(substring)},
+    {"string-length", unary<stringLength>()},
+    {"string-ref", binary<stringRef>()},
+    {"string=?", makeValue<BuiltinProcValue>(stringEq)},
+    {"string<?", makeValue<BuiltinProcValue>(stringLess)},
+    {"string->symbol", unary<stringToSymbol>()},
+    {"number->string", unary<numberToString>()},
+    {"string->number", unary<stringToNumber>()},
+    {"pmap", makeValue<BuiltinProcValue>(pmap)},
+    {"pmap?", makeValue<BuiltinProcValue>(isPmap)},
+    {"pmap-assoc", makeValue<BuiltinProcValue>(pmapAssoc)},
+    {"pmap-dissoc", binary<pmapDissoc>()},
+    {"pmap-get", makeValue<BuiltinProcValue>(pmapGet)},
+    {"pmap-count", unary<pmapCount>()},
+    {"pmap-keys", unary<pmapKeys>()},
+    {"pset", makeValue<BuiltinProcValue>(pset)},
+    {"pset?", makeValue<BuiltinProcValue>(isPset)},
+    {"pset-add", binary<psetAdd>()},
+    {"pset-remove", binary<psetRemove>()},
+    {"pset-contains?", binary<psetContains>()},
+    {"pset-count", unary<psetCount>()},
+    {"pset->list", unary<psetToList>()}
 };
\ No newline at end of file
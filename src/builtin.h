@@ -4,50 +4,109 @@
 #include "./eval_env.h"
 #include "./error.h"
 
-ValuePtr add(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr sub(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr mul(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr divide(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr printer(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr ABS(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr expt(const std::vector<ValuePtr>& args, EvalEnv& env); 
-ValuePtr modulo(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr quotient(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr Remainder(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr equal(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr eq(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr NOT(const std::vector<ValuePtr>& args, EvalEnv& env);  
-ValuePtr odd(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr even(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr zero(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr numEq(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr less(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr greater(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr lessEq(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr greaterEq(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr atom(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr boolean(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr number(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr pair(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr procedure(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr symbol(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr null(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr string(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr integer(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr list(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr append(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr car(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr cdr(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr cons(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr length(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr makelist(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr map(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr filter(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr reduce(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr setCar(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr setCdr(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr promise(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr force(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr add(ValueSpan args, EvalEnv& env);
+ValuePtr sub(ValueSpan args, EvalEnv& env);
+ValuePtr mul(ValueSpan args, EvalEnv& env);
+ValuePtr divide(ValueSpan args, EvalEnv& env);
+ValuePtr printer(ValueSpan args, EvalEnv& env);
+ValuePtr ABS(ValueSpan args, EvalEnv& env);
+ValuePtr expt(ValueSpan args, EvalEnv& env); 
+ValuePtr modulo(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv& env);
+ValuePtr quotient(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv& env);
+ValuePtr Remainder(const ValuePtr& dividend, const ValuePtr& divisor, EvalEnv& env);
+ValuePtr equal(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr eq(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr NOT(const ValuePtr& x, EvalEnv& env);  
+ValuePtr odd(ValueSpan args, EvalEnv& env);
+ValuePtr even(ValueSpan args, EvalEnv& env);
+ValuePtr zero(const ValuePtr& x, EvalEnv& env);
+ValuePtr numEq(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr less(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr greater(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr lessEq(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr greaterEq(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr atom(ValueSpan args, EvalEnv& env);
+ValuePtr boolean(ValueSpan args, EvalEnv& env);
+ValuePtr number(ValueSpan args, EvalEnv& env);
+ValuePtr pair(const ValuePtr& x, EvalEnv& env);
+ValuePtr procedure(ValueSpan args, EvalEnv& env);
+ValuePtr symbol(ValueSpan args, EvalEnv& env);
+ValuePtr symbolTableSize(ValueSpan args, EvalEnv& env);
+ValuePtr gc(ValueSpan args, EvalEnv& env);
+ValuePtr gcStats(ValueSpan args, EvalEnv& env);
+ValuePtr runtimeStats(ValueSpan args, EvalEnv& env);
+ValuePtr null(const ValuePtr& x, EvalEnv& env);
+ValuePtr string(ValueSpan args, EvalEnv& env);
+ValuePtr integer(ValueSpan args, EvalEnv& env);
+ValuePtr list(ValueSpan args, EvalEnv& env);
+ValuePtr append(ValueSpan args, EvalEnv& env);
+ValuePtr car(const ValuePtr& x, EvalEnv& env);
+ValuePtr cdr(const ValuePtr& x, EvalEnv& env);
+ValuePtr cons(const ValuePtr& x, const ValuePtr& y, EvalEnv& env);
+ValuePtr length(ValueSpan args, EvalEnv& env);
+ValuePtr makelist(ValueSpan args, EvalEnv& env);
+ValuePtr map(ValueSpan args, EvalEnv& env);
+ValuePtr filter(ValueSpan args, EvalEnv& env);
+ValuePtr reduce(ValueSpan args, EvalEnv& env);
+ValuePtr setCar(ValueSpan args, EvalEnv& env);
+ValuePtr setCdr(ValueSpan args, EvalEnv& env);
+ValuePtr promise(ValueSpan args, EvalEnv& env);
+ValuePtr force(ValueSpan args, EvalEnv& env);
+ValuePtr f64vector(ValueSpan args, EvalEnv& env);
+ValuePtr makeF64vector(ValueSpan args, EvalEnv& env);
+ValuePtr isF64vector(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorLength(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorRef(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorSet(ValueSpan args, EvalEnv& env);
+ValuePtr listToF64vector(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorToList(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorSum(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorDot(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorAdd(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorMul(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorScale(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorMin(ValueSpan args, EvalEnv& env);
+ValuePtr f64vectorMax(ValueSpan args, EvalEnv& env);
+ValuePtr vector(ValueSpan args, EvalEnv& env);
+ValuePtr makeVector(ValueSpan args, EvalEnv& env);
+ValuePtr isVector(ValueSpan args, EvalEnv& env);
+ValuePtr vectorLength(ValueSpan args, EvalEnv& env);
+ValuePtr vectorRef(const ValuePtr& v, const ValuePtr& k, EvalEnv& env);
+ValuePtr vectorSet(ValueSpan args, EvalEnv& env);
+ValuePtr vectorFill(ValueSpan args, EvalEnv& env);
+ValuePtr listToVector(ValueSpan args, EvalEnv& env);
+ValuePtr vectorToList(ValueSpan args, EvalEnv& env);
+ValuePtr makeHashTable(ValueSpan args, EvalEnv& env);
+ValuePtr isHashTable(ValueSpan args, EvalEnv& env);
+ValuePtr hashRef(ValueSpan args, EvalEnv& env);
+ValuePtr hashSet(ValueSpan args, EvalEnv& env);
+ValuePtr hashRemove(ValueSpan args, EvalEnv& env);
+ValuePtr hashCount(ValueSpan args, EvalEnv& env);
+ValuePtr hashKeys(ValueSpan args, EvalEnv& env);
+ValuePtr stringAppend(ValueSpan args, EvalEnv& env);
+ValuePtr stringJoin(ValueSpan args, EvalEnv& env);
+ValuePtr substring(ValueSpan args, EvalEnv& env);
+ValuePtr stringLength(const ValuePtr& x, EvalEnv& env);
+ValuePtr stringRef(const ValuePtr& x, const ValuePtr& k, EvalEnv& env);
+ValuePtr stringEq(ValueSpan args, EvalEnv& env);
+ValuePtr stringLess(ValueSpan args, EvalEnv& env);
+ValuePtr stringToSymbol(const ValuePtr& x, EvalEnv& env);
+ValuePtr numberToString(const ValuePtr& x, EvalEnv& env);
+ValuePtr stringToNumber(const ValuePtr& x, EvalEnv& env);
+ValuePtr pmap(ValueSpan args, EvalEnv& env);
+ValuePtr isPmap(ValueSpan args, EvalEnv& env);
+ValuePtr pmapAssoc(ValueSpan args, EvalEnv& env);
+ValuePtr pmapDissoc(const ValuePtr& map, const ValuePtr& key, EvalEnv& env);
+ValuePtr pmapGet(ValueSpan args, EvalEnv& env);
+ValuePtr pmapCount(const ValuePtr& map, EvalEnv& env);
+ValuePtr pmapKeys(const ValuePtr& map, EvalEnv& env);
+ValuePtr pset(ValueSpan args, EvalEnv& env);
+ValuePtr isPset(ValueSpan args, EvalEnv& env);
+ValuePtr psetAdd(const ValuePtr& set, const ValuePtr& x, EvalEnv& env);
+ValuePtr psetRemove(const ValuePtr& set, const ValuePtr& x, EvalEnv& env);
+ValuePtr psetContains(const ValuePtr& set, const ValuePtr& x, EvalEnv& env);
+ValuePtr psetCount(const ValuePtr& set, EvalEnv& env);
+ValuePtr psetToList(const ValuePtr& set, EvalEnv& env);
 
 extern std::unordered_map<std::string, ValuePtr> BUILTIN;
 
@@ -0,0 +1,252 @@
+#include "./compiler.h"
+#include "./analyzer.h"
+
+std::shared_ptr<const Chunk> Compiler::compile(const Node& node){
+    auto chunk = std::make_shared<Chunk>();
+    Compiler c(*chunk);
+    node.compileTail(c);
+    return chunk;
+}
+
+void Compiler::compile(const NodePtr& node, bool tail){
+    if (tail)
+        node->compileTail(*this);
+    else
+        node->compile(*this);
+}
+
+void Compiler::emit(Op op, std::initializer_list<uint32_t> operands){
+    chunk.code.push_back(static_cast<uint32_t>(op));
+    chunk.code.insert(chunk.code.end(), operands);
+}
+
+size_t Compiler::emitJump(Op op, std::initializer_list<uint32_t> operands){
+    emit(op, operands);
+    chunk.code.push_back(0);
+    return chunk.code.size() - 1;
+}
+
+uint32_t Compiler::constant(ValuePtr value){
+    chunk.constants.push_back(std::move(value));
+    return static_cast<uint32_t>(chunk.constants.size() - 1);
+}
+
+uint32_t Compiler::name(Symbol name){
+    for (size_t i = 0; i < chunk.names.size(); i++)
+        if (chunk.names[i] == name)
+            return static_cast<uint32_t>(i);
+    chunk.names.push_back(name);
+    return static_cast<uint32_t>(chunk.names.size() - 1);
+}
+
+uint32_t Compiler::lambda(std::shared_ptr<const LambdaNode> lambda){
+    chunk.lambdas.push_back(std::move(lambda));
+    return static_cast<uint32_t>(chunk.lambdas.size() - 1);
+}
+
+uint32_t Compiler::scope(std::shared_ptr<Scope> scope){
+    chunk.scopes.push_back(std::move(scope));
+    return static_cast<uint32_t>(chunk.scopes.size() - 1);
+}
+
+uint32_t Compiler::cache(){
+    chunk.caches.emplace_back();
+    return static_cast<uint32_t>(chunk.caches.size() - 1);
+}
+
+static void emitNil(Compiler& c, bool tail){
+    c.emit(Op::CONST, {c.constant(ValuePtr::nil())});
+    if (tail)
+        c.emit(Op::RETURN);
+}
+
+void Node::compileTail(Compiler& c) const {
+    compile(c);
+    c.emit(Op::RETURN);
+}
+
+const Chunk& LambdaNode::compiled() const {
+    if (!chunk)
+        chunk = Compiler::compile(*body);
+    return *chunk;
+}
+
+void ConstantNode::compile(Compiler& c) const {
+    c.emit(Op::CONST, {c.constant(value)});
+}
+
+void LocalVariableNode::compile(Compiler& c) const {
+    c.emit(Op::LOCAL, {static_cast<uint32_t>(depth), static_cast<uint32_t>(slot)});
+}
+
+void GlobalVariableNode::compile(Compiler& c) const {
+    c.emit(Op::GLOBAL, {c.name(name), static_cast<uint32_t>(depth), c.cache()});
+}
+
+void GlobalDefineNode::compile(Compiler& c) const {
+    value->compile(c);
+    c.emit(Op::DEFINE_GLOBAL, {c.name(name)});
+}
+
+void LocalDefineNode::compile(Compiler& c) const {
+    value->compile(c);
+    c.emit(Op::DEFINE_LOCAL, {static_cast<uint32_t>(slot)});
+}
+
+void IfNode::generate(Compiler& c, bool tail) const {
+    test->compile(c);
+    auto otherwise = c.emitJump(Op::JUMP_IF_FALSE);
+    c.compile(consequent, tail);
+    size_t end = 0;
+    if (!tail)
+        end = c.emitJump(Op::JUMP);
+    c.patch(otherwise);
+    if (alternative)
+        c.compile(alternative, tail);
+    else
+        emitNil(c, tail);
+    if (!tail)
+        c.patch(end);
+}
+
+// and/or leave the deciding operand on the stack and jump past the rest; in
+// tail position that value still has to be returned.
+static void shortCircuit(Compiler& c, bool tail, const std::vector<NodePtr>& operands, Op jump){
+    std::vector<size_t> exits;
+    for (size_t i = 0; i + 1 < operands.size(); i++) {
+        operands[i]->compile(c);
+        exits.push_back(c.emitJump(jump));
+    }
+    c.compile(operands.back(), tail);
+    for (auto exit : exits)
+        c.patch(exit);
+    if (tail && !exits.empty())
+        c.emit(Op::RETURN);
+}
+
+void AndNode::generate(Compiler& c, bool tail) const {
+    if (operands.empty()) {
+        c.emit(Op::CONST, {c.constant(ValuePtr::boolean(true))});
+        if (tail) c.emit(Op::RETURN);
+        return;
+    }
+    shortCircuit(c, tail, operands, Op::JUMP_IF_FALSE_KEEP);
+}
+
+void OrNode::generate(Compiler& c, bool tail) const {
+    if (operands.empty()) {
+        c.emit(Op::CONST, {c.constant(ValuePtr::boolean(false))});
+        if (tail) c.emit(Op::RETURN);
+        return;
+    }
+    shortCircuit(c, tail, operands, Op::JUMP_IF_TRUE_KEEP);
+}
+
+void SequenceNode::generate(Compiler& c, bool tail) const {
+    if (body.empty())
+        return emitNil(c, tail);
+    for (size_t i = 0; i + 1 < body.size(); i++) {
+        body[i]->compile(c);
+        c.emit(Op::POP);
+    }
+    c.compile(body.back(), tail);
+}
+
+void LambdaNode::compile(Compiler& c) const {
+    c.emit(Op::CLOSURE, {c.lambda(shared_from_this())});
+}
+
+// A call of a global reads the procedure through the global's cache when
+// the call is made instead of pushing it first. The name is still resolved
+// before the operands run, so an unbound procedure is reported first, as
+// the tree-walker does.
+void CallNode::generate(Compiler& c, bool tail) const {
+    auto global = dynamic_cast<const GlobalVariableNode*>(op.get());
+    if (!global) {
+        op->compile(c);
+        for (const auto& operand : operands)
+            operand->compile(c);
+        c.emit(tail ? Op::TAIL_CALL : Op::CALL, {static_cast<uint32_t>(operands.size())});
+        return;
+    }
+    auto name = c.name(global->getName());
+    auto depth = static_cast<uint32_t>(global->getDepth());
+    auto cache = c.cache();
+    if (!operands.empty())
+        c.emit(Op::CHECK_GLOBAL, {name, depth, cache});
+    for (const auto& operand : operands)
+        operand->compile(c);
+    c.emit(tail ? Op::TAIL_CALL_GLOBAL : Op::CALL_GLOBAL, {name, depth, cache, static_cast<uint32_t>(operands.size())});
+}
+
+// In tail position the body returns straight out of the procedure, so the
+// frame it entered never needs leaving.
+void LetNode::generate(Compiler& c, bool tail) const {
+    for (const auto& init : inits)
+        init->compile(c);
+    c.emit(Op::ENTER, {c.scope(scope), static_cast<uint32_t>(inits.size())});
+    c.compile(body, tail);
+    if (!tail)
+        c.emit(Op::LEAVE);
+}
+
+// The key stays on the stack while the data are tried; each clause body
+// starts by dropping it.
+void CaseNode::generate(Compiler& c, bool tail) const {
+    key->compile(c);
+    std::vector<std::vector<size_t>> matches(clauses.size());
+    for (size_t i = 0; i < clauses.size(); i++)
+        for (const auto& datum : clauses[i].data)
+            matches[i].push_back(c.emitJump(Op::CASE_MATCH, {c.constant(datum)}));
+    std::vector<size_t> ends;
+    c.emit(Op::POP);
+    if (elseBody)
+        c.compile(elseBody, tail);
+    else
+        emitNil(c, tail);
+    if (!tail)
+        ends.push_back(c.emitJump(Op::JUMP));
+    for (size_t i = 0; i < clauses.size(); i++) {
+        for (auto match : matches[i])
+            c.patch(match);
+        c.emit(Op::POP);
+        c.compile(clauses[i].body, tail);
+        if (!tail)
+            ends.push_back(c.emitJump(Op::JUMP));
+    }
+    for (auto end : ends)
+        c.patch(end);
+}
+
+void ConsNode::compile(Compiler& c) const {
+    car->compile(c);
+    cdr->compile(c);
+    c.emit(Op::CONS);
+}
+
+void DelayNode::compile(Compiler& c) const {
+    thunk->compile(c);
+    c.emit(Op::PROMISE);
+}
+
+void DoNode::generate(Compiler& c, bool tail) const {
+    for (const auto& init : inits)
+        init->compile(c);
+    c.emit(Op::ENTER, {c.scope(scope), static_cast<uint32_t>(inits.size())});
+    auto loop = c.here();
+    test->compile(c);
+    auto exit = c.emitJump(Op::JUMP_IF_TRUE);
+    body->compile(c);
+    c.emit(Op::POP);
+    for (size_t i = 0; i < steps.size(); i++) {
+        if (!steps[i])
+            continue;
+        steps[i]->compile(c);
+        c.emit(Op::SET_LOCAL, {static_cast<uint32_t>(i)});
+    }
+    c.emit(Op::JUMP, {loop});
+    c.patch(exit);
+    c.compile(result, tail);
+    if (!tail)
+        c.emit(Op::LEAVE);
+}
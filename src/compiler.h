@@ -0,0 +1,75 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "./node.h"
+#include <cstdint>
+
+// Every instruction is one opcode word followed by its operand words.
+// Jump targets are absolute offsets into the chunk's code.
+#define MINI_LISP_OPCODES(X)                                                   \
+    X(CONST)              /* k: push constants[k] */                           \
+    X(LOCAL)              /* depth slot: push a local variable */              \
+    X(GLOBAL)             /* k depth c: push global names[k] via caches[c] */  \
+    X(DEFINE_GLOBAL)      /* k: pop into global names[k], push () */           \
+    X(DEFINE_LOCAL)       /* slot: pop into slot of this frame, push () */     \
+    X(SET_LOCAL)          /* slot: pop into slot of this frame */              \
+    X(POP)                                                                     \
+    X(JUMP)               /* target */                                         \
+    X(JUMP_IF_FALSE)      /* target: pop, jump if #f */                        \
+    X(JUMP_IF_TRUE)       /* target: pop, jump unless #f */                    \
+    X(JUMP_IF_FALSE_KEEP) /* target: jump if top is #f, else pop it */         \
+    X(JUMP_IF_TRUE_KEEP)  /* target: jump unless top is #f, else pop it */     \
+    X(CALL)               /* n: call the procedure below n arguments */        \
+    X(TAIL_CALL)          /* n: as CALL, replacing the current frame */        \
+    X(CHECK_GLOBAL)       /* k depth c: fail now if names[k] is unbound */     \
+    X(CALL_GLOBAL)        /* k depth c n: call global names[k] with n args */  \
+    X(TAIL_CALL_GLOBAL)   /* k depth c n: as CALL_GLOBAL, replacing frame */   \
+    X(RETURN)                                                                  \
+    X(CLOSURE)            /* k: push a procedure for lambdas[k] */             \
+    X(PROMISE)            /* wrap the thunk on top in a promise */             \
+    X(CONS)                                                                    \
+    X(ENTER)              /* k n: pop n values into a frame for scopes[k] */   \
+    X(LEAVE)              /* return to the enclosing frame */                  \
+    X(CASE_MATCH)         /* k target: jump if top is equal? to constants[k] */
+
+enum class Op : uint32_t {
+#define MINI_LISP_OPCODE_ENUM(name) name,
+    MINI_LISP_OPCODES(MINI_LISP_OPCODE_ENUM)
+#undef MINI_LISP_OPCODE_ENUM
+};
+
+// The compiled form of one procedure body or one top-level expression,
+// together with everything its operands index into.
+struct Chunk {
+    std::vector<uint32_t> code;
+    std::vector<ValuePtr> constants;
+    std::vector<Symbol> names;
+    std::vector<std::shared_ptr<const LambdaNode>> lambdas;
+    std::vector<std::shared_ptr<Scope>> scopes;
+    mutable std::vector<GlobalCache> caches;
+};
+
+// Lowers analyzed nodes to bytecode for the VM. The nodes already carry
+// resolved slots and scopes, so this is a single walk with no lookups.
+class Compiler {
+private:
+    Chunk& chunk;
+    Compiler(Chunk& chunk) : chunk{chunk} {}
+public:
+    static std::shared_ptr<const Chunk> compile(const Node& node);
+
+    void compile(const NodePtr& node, bool tail);
+    void emit(Op op, std::initializer_list<uint32_t> operands = {});
+    // Emits a jump with a placeholder target and returns where to patch it.
+    size_t emitJump(Op op, std::initializer_list<uint32_t> operands = {});
+    void patch(size_t at) {chunk.code[at] = here();}
+    uint32_t here() const {return static_cast<uint32_t>(chunk.code.size());}
+
+    uint32_t constant(ValuePtr value);
+    uint32_t name(Symbol name);
+    uint32_t lambda(std::shared_ptr<const LambdaNode> lambda);
+    uint32_t scope(std::shared_ptr<Scope> scope);
+    uint32_t cache();
+};
+
+#endif
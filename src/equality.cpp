@@ -0,0 +1,186 @@
+#include "./equality.h"
+#include "./hamt.h"
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// How many pairs, vector elements and atoms hashEqual looks at.
+constexpr int HASH_BUDGET = 64;
+
+size_t mix(size_t seed, size_t value){
+    uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+
+bool sameNumber(const ValuePtr& x, const ValuePtr& y){
+    if (x.isInt64() && y.isInt64())
+        return x.asInteger() == y.asInteger();
+    if (x.isExact() && y.isExact())
+        return x.asBigInt().compare(y.asBigInt()) == 0;
+    double a = x.asNumber(), b = y.asNumber();
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// Equal numbers are equal as doubles, so hashing the double agrees with
+// sameNumber; -0.0 is folded into 0.0 and NaN is already canonical.
+size_t hashNumber(const ValuePtr& value){
+    double number = value.asNumber();
+    if (number == 0)
+        number = 0;
+    return mix(static_cast<size_t>(ValueType::NUMERIC), std::hash<double>{}(number));
+}
+
+size_t hashStructure(const ValuePtr& value, int& budget){
+    if (--budget < 0)
+        return 0;
+    auto type = value.getType();
+    switch (type) {
+    case ValueType::NUMERIC:
+        return hashNumber(value);
+    case ValueType::SYMBOL:
+        return mix(static_cast<size_t>(type), std::hash<Symbol>{}(*value.asSymbol()));
+    case ValueType::STRING:
+        return mix(static_cast<size_t>(type), std::hash<std::string_view>{}(static_cast<StringValue*>(value.get())->getValue()));
+    case ValueType::PAIR: {
+        size_t hash = static_cast<size_t>(type);
+        ValuePtr current = value;
+        while (current.getType() == ValueType::PAIR && budget > 0) {
+            auto pair = static_cast<PairValue*>(current.get());
+            hash = mix(hash, hashStructure(pair->getCar(), budget));
+            current = pair->getCdr();
+        }
+        return mix(hash, hashStructure(current, budget));
+    }
+    case ValueType::VECTOR: {
+        size_t hash = static_cast<size_t>(type);
+        for (const auto& element : static_cast<VectorValue*>(value.get())->getElements()) {
+            if (budget <= 0)
+                break;
+            hash = mix(hash, hashStructure(element, budget));
+        }
+        return hash;
+    }
+    case ValueType::F64VECTOR: {
+        size_t hash = static_cast<size_t>(type);
+        for (double element : static_cast<F64VectorValue*>(value.get())->getElements()) {
+            if (budget-- <= 0)
+                break;
+            hash = mix(hash, std::hash<double>{}(element == 0 ? 0 : element));
+        }
+        return hash;
+    }
+    case ValueType::PMAP:
+    case ValueType::PSET:
+        return mix(static_cast<size_t>(type), static_cast<PersistentMapValue*>(value.get())->contentHash());
+    default:
+        return Equality::hashEq(value);
+    }
+}
+
+}
+
+bool Equality::eq(const ValuePtr& x, const ValuePtr& y){
+    if (x.isNumber() && y.isNumber())
+        return sameNumber(x, y);
+    if (x.getType() == ValueType::SYMBOL && y.getType() == ValueType::SYMBOL)
+        return *x.asSymbol() == *y.asSymbol();
+    return x == y;
+}
+
+bool Equality::equal(const ValuePtr& x, const ValuePtr& y){
+    // equal never calls back into the interpreter, so one stack serves
+    // every comparison. Looking keys up in a persistent map compares them
+    // with equal again, on top of the part of the stack in use.
+    static std::vector<std::pair<const ValuePtr*, const ValuePtr*>> pending;
+    size_t base = pending.size();
+    pending.emplace_back(&x, &y);
+    bool result = true;
+    while (result && pending.size() > base) {
+        auto [lhs, rhs] = pending.back();
+        pending.pop_back();
+        if (*lhs == *rhs)
+            continue;
+        auto type = lhs->getType();
+        if (type != rhs->getType()) {
+            result = false;
+            break;
+        }
+        switch (type) {
+        case ValueType::STRING:
+            if (static_cast<StringValue*>(lhs->get())->getValue() != static_cast<StringValue*>(rhs->get())->getValue())
+                result = false;
+            break;
+        case ValueType::F64VECTOR:
+            if (static_cast<F64VectorValue*>(lhs->get())->getElements()
+                != static_cast<F64VectorValue*>(rhs->get())->getElements())
+                result = false;
+            break;
+        case ValueType::PAIR: {
+            // The cdrs go below the cars, so a list is compared front to
+            // back while the stack stays as deep as the list is nested.
+            auto left = static_cast<PairValue*>(lhs->get());
+            auto right = static_cast<PairValue*>(rhs->get());
+            pending.emplace_back(&left->getCdr(), &right->getCdr());
+            pending.emplace_back(&left->getCar(), &right->getCar());
+            break;
+        }
+        case ValueType::VECTOR: {
+            const auto& left = static_cast<VectorValue*>(lhs->get())->getElements();
+            const auto& right = static_cast<VectorValue*>(rhs->get())->getElements();
+            if (left.size() != right.size()) {
+                result = false;
+                break;
+            }
+            for (size_t i = left.size(); i-- > 0;)
+                pending.emplace_back(&left[i], &right[i]);
+            break;
+        }
+        case ValueType::PMAP:
+        case ValueType::PSET: {
+            auto left = static_cast<PersistentMapValue*>(lhs->get());
+            auto right = static_cast<PersistentMapValue*>(rhs->get());
+            if (left->size() != right->size() || left->contentHash() != right->contentHash()) {
+                result = false;
+                break;
+            }
+            // Every key of one must be in the other, and for maps the
+            // values under it are compared in turn.
+            left->forEach([&](const HamtEntry& entry){
+                if (!result)
+                    return;
+                if (auto value = right->find(entry.key)) {
+                    if (!left->isSet())
+                        pending.emplace_back(&entry.value, value);
+                } else {
+                    result = false;
+                }
+            });
+            break;
+        }
+        default:
+            if (!eq(*lhs, *rhs))
+                result = false;
+        }
+    }
+    pending.resize(base);
+    return result;
+}
+
+size_t Equality::hashEq(const ValuePtr& value){
+    if (value.isNumber())
+        return hashNumber(value);
+    if (auto symbol = value.asSymbol())
+        return mix(static_cast<size_t>(ValueType::SYMBOL), std::hash<Symbol>{}(*symbol));
+    return mix(0, static_cast<size_t>(value.raw()));
+}
+
+size_t Equality::hashEqual(const ValuePtr& value){
+    int budget = HASH_BUDGET;
+    return hashStructure(value, budget);
+}
@@ -0,0 +1,28 @@
+#ifndef EQUALITY_H
+#define EQUALITY_H
+
+#include "./value.h"
+#include <cstddef>
+
+// The two equivalences of the language, and hash functions that agree with
+// them, so hash tables can be keyed by either. eq? compares numbers by
+// value, symbols by name and anything else by identity; equal? also
+// compares pairs, vectors, f64vectors and strings by their contents.
+// Numbers are equal when they are the same exact integer, or otherwise
+// when they are the same as doubles.
+//
+// equal walks both structures together with an explicit stack of the
+// pairs of values still to compare, so it allocates nothing once that
+// stack has grown, and neither long lists nor deeply nested ones recurse.
+class Equality {
+public:
+    static bool eq(const ValuePtr& x, const ValuePtr& y);
+    static bool equal(const ValuePtr& x, const ValuePtr& y);
+    // Values that are eq? hash alike.
+    static size_t hashEq(const ValuePtr& value);
+    // Values that are equal? hash alike. Only the first few dozen nodes of
+    // a large structure contribute, which bounds the cost of hashing it.
+    static size_t hashEqual(const ValuePtr& value);
+};
+
+#endif
@@ -1,96 +1,106 @@
 #include "./eval_env.h"
 #include "./error.h"
 #include "./builtin.h"
-#include "./forms.h"
-#include <algorithm>
-#include <iterator>
-#include <unordered_set>
+#include "./analyzer.h"
+#include "./vm.h"
 
 using namespace std::literals;
 
-EvalEnv::EvalEnv(std::shared_ptr<EvalEnv> parent) : parent{parent} {
-    for(auto& [name, proc] : BUILTIN)
-        env[name] = proc;
+Engine EvalEnv::engine = Engine::TREE;
+
+EvalEnv::EvalEnv(EnvPtr parent) : parent{std::move(parent)} {
+    Stats::count(Stats::ENVIRONMENTS);
+}
+
+EvalEnv::EvalEnv(EnvPtr parent, std::shared_ptr<Scope> scope, Slots slots)
+    : slots{std::move(slots)}, scope{std::move(scope)}, parent{std::move(parent)} {
+    this->slots.resize(this->scope->names.size());
+    Stats::count(Stats::ENVIRONMENTS);
+}
+
+EnvPtr EvalEnv::builtins(){
+    static const EnvPtr frame = []{
+        auto frame = EnvPtr(new EvalEnv(nullptr));
+        for (const auto& [name, proc] : BUILTIN) {
+            static_cast<BuiltinProcValue*>(proc.get())->setName(Symbol::intern(name));
+            frame->env.emplace(Symbol::intern(name), proc);
+        }
+        return frame;
+    }();
+    return frame;
 }
 
-std::shared_ptr<EvalEnv> EvalEnv::createGlobal(){
-        return std::shared_ptr<EvalEnv>(new EvalEnv(nullptr));
+EnvPtr EvalEnv::createGlobal(){
+        return EnvPtr(new EvalEnv(builtins()));
 }; 
 
-std::shared_ptr<EvalEnv> EvalEnv::createChild(const std::vector<std::string>& params, const std::vector<ValuePtr>& args) {
-    auto child = std::shared_ptr<EvalEnv>(new EvalEnv(shared_from_this()));
-    for (size_t i = 0; i < params.size(); i++)
-        child->defineBinding(params[i], args[i]);
+EnvPtr EvalEnv::createChild(std::shared_ptr<Scope> scope, Slots args) {
+    EnvPtr child(new EvalEnv(EnvPtr(this), std::move(scope), std::move(args)));
+    Heap::allocated();
     return child;
 }
 
-void EvalEnv::defineBinding(const std::string& name, ValuePtr value){
-    env[name] = value;
+void EvalEnv::trace(Tracer& tracer) const {
+    for (const auto& [name, value] : env)
+        tracer.visit(value.get());
+    for (const auto& slot : slots)
+        tracer.visit(slot.get());
+    tracer.visit(parent.get());
 }
 
-ValuePtr EvalEnv::lookupBinding(const std::string& name){
-    if(this->env.find(name) == this->env.end() && this->parent)
-        return this->parent->lookupBinding(name);
-    else if(this->env.find(name) != this->env.end())
-        return this->env[name];
-    else
-        throw LispError("Variable " + name + " not defined.");
+void EvalEnv::clearReferences() {
+    if (!env.empty())
+        globalVersion++;
+    env.clear();
+    slots.clear();
+    parent = nullptr;
 }
 
-ValuePtr EvalEnv::eval(ValuePtr expr){
-    if (expr->isSelfEvaluating())
-        return expr;
-    else if (auto symbol = expr->asSymbol()){
-        if (auto value = lookupBinding(*symbol))
-            return value;
-        else
-            throw LispError("Variable " + *symbol + " not defined.");
-    }
-    else if (expr->getType() == ValueType::PAIR){
-        auto islist = list({expr}, *this);
-        if(!static_cast<BooleanValue*>(islist.get())->getValue()){
-            std::string msg = "Malformed list: " + expr->toString();
-            throw LispError("Malformed list");
-        }
-        else{
-            auto Pair = static_cast<PairValue*>(expr.get());
-            auto op = Pair->getCar()->asSymbol();
-            if (op.has_value() && SPECIAL_FORMS.find(*op) != SPECIAL_FORMS.end())
-                return SPECIAL_FORMS.at(*op)(Pair->getCdr()->toVector(), *this);   
-            else
-            {
-                ValuePtr operands = Pair->getCdr();
-                auto proc = this->eval(Pair->getCar());
-                if(proc->getType()==ValueType::BUILTIN_PROC || proc->getType()==ValueType::LAMBDA){
-                    std::vector<ValuePtr> args = evalList(operands);
-                    return this->apply(proc, args);
-                }
-                else return expr;
-            }
-        }
-    }
-    else if (expr->isNil()){
-        throw LispError("Cannot evaluate nil");
-    }
-    else {
-        throw LispError("Undefined expression type");
+void EvalEnv::unbound(size_t index) const {
+    throw LispError("Variable " + scope->names.at(index).str() + " not defined.");
+}
+
+void EvalEnv::defineBinding(Symbol name, ValuePtr value){
+    if(scope)
+        setSlot(scope->declare(name), std::move(value));
+    else if (env.insert_or_assign(name, std::move(value)).second)
+        globalVersion++;
+}
+
+ValuePtr EvalEnv::lookupBinding(Symbol name){
+    if(scope){
+        if(auto slot = scope->find(name))
+            return getSlot(*slot);
+        return parent->lookupBinding(name);
     }
+    return lookupGlobal(name);
 }
 
-std::vector<ValuePtr> EvalEnv::evalList(ValuePtr expr) {
-    std::vector<ValuePtr> result;
-    std::ranges::transform(static_cast<PairValue*>(expr.get())->toVector(),
-                           std::back_inserter(result),
-                           [this](ValuePtr v) { return this->eval(v); });
-    return result;
+ValuePtr EvalEnv::lookupGlobal(Symbol name){
+    return findGlobal(name);
+}
+
+const ValuePtr& EvalEnv::findGlobal(Symbol name){
+    auto binding = env.find(name);
+    if(binding != env.end())
+        return binding->second;
+    if(parent)
+        return parent->findGlobal(name);
+    throw LispError("Variable " + name.str() + " not defined.");
+}
+
+ValuePtr EvalEnv::eval(ValuePtr expr){
+    auto node = Analyzer(scope).analyze(expr);
+    if (engine == Engine::VM)
+        return VM::run(*Compiler::compile(*node), EnvPtr(this));
+    return node->eval(*this);
 }
 
-ValuePtr EvalEnv::apply(ValuePtr proc, std::vector<ValuePtr> args) {
-    if (typeid(*proc) == typeid(BuiltinProcValue)) {
-        auto procedure = static_cast<BuiltinProcValue*>(proc.get())->getFunc();
-        return procedure(args, *this);
+ValuePtr EvalEnv::apply(const ValuePtr& proc, ValueSpan args) {
+    if (proc.getType() == ValueType::BUILTIN_PROC) {
+        return static_cast<BuiltinProcValue*>(proc.get())->call(args, *this);
     } 
-    else if (typeid(*proc) == typeid(LambdaValue)) {
+    else if (proc.getType() == ValueType::LAMBDA) {
         auto lambda = static_cast<LambdaValue*>(proc.get());
         return lambda->apply(args);
     } 
@@ -4,21 +4,79 @@
 #include "./value.h"
 #include <unordered_map>
 
-using ValuePtr = std::shared_ptr<Value>;
+struct Scope;
 
-class EvalEnv : public std::enable_shared_from_this<EvalEnv>{
+// Which evaluator runs analyzed code: the tree-walker over nodes, which is
+// the reference implementation, or the bytecode VM.
+enum class Engine { TREE, VM };
+
+// What one reference to a global found the last time it ran: the binding
+// cell, valid while the global version it was found at is still current.
+struct GlobalCache {
+    uint64_t version = 0;
+    const ValuePtr* cell = nullptr;
+};
+
+// The global frame keeps its bindings in a hash map so top-level code can
+// define new names at any time; below it sits one shared, never-modified
+// frame holding the builtins, which a global define simply shadows. Every
+// other frame is a flat array of slots
+// laid out by the Scope its code was analyzed in, and analyzed code reaches
+// a local by walking a fixed number of parents and indexing a slot.
+class EvalEnv : public GcObject {
 private:
-    std::unordered_map<std::string, ValuePtr> env;
-    std::shared_ptr<EvalEnv> parent {nullptr};    
-    EvalEnv(std::shared_ptr<EvalEnv> parent);
+    std::unordered_map<Symbol, ValuePtr> env;
+    Slots slots;
+    std::shared_ptr<Scope> scope {nullptr};
+    EnvPtr parent {nullptr};
+    EvalEnv(EnvPtr parent);
+    EvalEnv(EnvPtr parent, std::shared_ptr<Scope> scope, Slots slots);
+    [[noreturn]] void unbound(size_t index) const;
+    static Engine engine;
+    // Bumped whenever a global frame gains or loses a binding, which may
+    // change the cell a name resolves to. Assigning to an existing binding
+    // keeps its cell, so cached cells still see the new value.
+    static inline uint64_t globalVersion = 1;
 public:
-    static std::shared_ptr<EvalEnv> createGlobal();
-    std::shared_ptr<EvalEnv> createChild(const std::vector<std::string>& params, const std::vector<ValuePtr>& args);
-    ValuePtr lookupBinding(const std::string& name);
-    void defineBinding(const std::string& name, ValuePtr value);   
+    static void setEngine(Engine e) {engine = e;}
+    static Engine getEngine() {return engine;}
+    static EnvPtr builtins();
+    static EnvPtr createGlobal();
+    EnvPtr createChild(std::shared_ptr<Scope> scope, Slots args);
+    ValuePtr lookupBinding(Symbol name);
+    ValuePtr lookupGlobal(Symbol name);
+    const ValuePtr& findGlobal(Symbol name);
+    // The global name, depth frames up from here, through cache.
+    const ValuePtr& lookupGlobal(Symbol name, size_t depth, GlobalCache& cache) {
+        if (cache.version != globalVersion) {
+            cache.cell = &ancestor(depth)->findGlobal(name);
+            cache.version = globalVersion;
+        }
+        return *cache.cell;
+    }
+    void defineBinding(Symbol name, ValuePtr value);   
+    const std::shared_ptr<Scope>& getScope() const {return scope;}
+    const EnvPtr& getParent() const {return parent;}
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+    EvalEnv* ancestor(size_t depth) {
+        EvalEnv* frame = this;
+        for (; depth > 0; depth--)
+            frame = frame->parent.get();
+        return frame;
+    }
+    const ValuePtr& getSlot(size_t index) const {
+        if (index >= slots.size() || !slots[index])
+            unbound(index);
+        return slots[index];
+    }
+    void setSlot(size_t index, ValuePtr value) {
+        if (index >= slots.size())
+            slots.resize(index + 1);
+        slots[index] = std::move(value);
+    }
     ValuePtr eval(ValuePtr expr);
-    std::vector<ValuePtr> evalList(ValuePtr expr);
-    ValuePtr apply(ValuePtr proc, std::vector<ValuePtr> args);
+    ValuePtr apply(const ValuePtr& proc, ValueSpan args);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,297 @@
+#include "./f64kernels.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MINI_LISP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// One implementation of every kernel; the dispatcher picks a table.
+struct KernelTable {
+    double (*sum)(const double*, size_t);
+    double (*dot)(const double*, const double*, size_t);
+    double (*min)(const double*, size_t);
+    double (*max)(const double*, size_t);
+    void (*add)(const double*, const double*, double*, size_t);
+    void (*mul)(const double*, const double*, double*, size_t);
+    void (*scale)(const double*, double, double*, size_t);
+};
+
+namespace scalar {
+
+double sum(const double* x, size_t n){
+    double result = 0;
+    for (size_t i = 0; i < n; i++)
+        result += x[i];
+    return result;
+}
+
+double dot(const double* x, const double* y, size_t n){
+    double result = 0;
+    for (size_t i = 0; i < n; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+double min(const double* x, size_t n){
+    return *std::min_element(x, x + n);
+}
+
+double max(const double* x, size_t n){
+    return *std::max_element(x, x + n);
+}
+
+void add(const double* x, const double* y, double* out, size_t n){
+    for (size_t i = 0; i < n; i++)
+        out[i] = x[i] + y[i];
+}
+
+void mul(const double* x, const double* y, double* out, size_t n){
+    for (size_t i = 0; i < n; i++)
+        out[i] = x[i] * y[i];
+}
+
+void scale(const double* x, double factor, double* out, size_t n){
+    for (size_t i = 0; i < n; i++)
+        out[i] = x[i] * factor;
+}
+
+constexpr KernelTable table{sum, dot, min, max, add, mul, scale};
+
+}
+
+#ifdef MINI_LISP_X86_KERNELS
+
+// SSE2 is part of x86-64, so these need no check. Reductions run two
+// accumulators of two lanes each to hide the latency of the adds.
+namespace sse2 {
+
+double horizontal(__m128d v){
+    double lanes[2];
+    _mm_storeu_pd(lanes, v);
+    return lanes[0] + lanes[1];
+}
+
+double sum(const double* x, size_t n){
+    __m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = _mm_add_pd(a, _mm_loadu_pd(x + i));
+        b = _mm_add_pd(b, _mm_loadu_pd(x + i + 2));
+    }
+    double result = horizontal(_mm_add_pd(a, b));
+    for (; i < n; i++)
+        result += x[i];
+    return result;
+}
+
+double dot(const double* x, const double* y, size_t n){
+    __m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = _mm_add_pd(a, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        b = _mm_add_pd(b, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+    }
+    double result = horizontal(_mm_add_pd(a, b));
+    for (; i < n; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+double min(const double* x, size_t n){
+    if (n < 2)
+        return x[0];
+    __m128d m = _mm_loadu_pd(x);
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2)
+        m = _mm_min_pd(m, _mm_loadu_pd(x + i));
+    double lanes[2];
+    _mm_storeu_pd(lanes, m);
+    double result = std::min(lanes[0], lanes[1]);
+    for (; i < n; i++)
+        result = std::min(result, x[i]);
+    return result;
+}
+
+double max(const double* x, size_t n){
+    if (n < 2)
+        return x[0];
+    __m128d m = _mm_loadu_pd(x);
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2)
+        m = _mm_max_pd(m, _mm_loadu_pd(x + i));
+    double lanes[2];
+    _mm_storeu_pd(lanes, m);
+    double result = std::max(lanes[0], lanes[1]);
+    for (; i < n; i++)
+        result = std::max(result, x[i]);
+    return result;
+}
+
+void add(const double* x, const double* y, double* out, size_t n){
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    for (; i < n; i++)
+        out[i] = x[i] + y[i];
+}
+
+void mul(const double* x, const double* y, double* out, size_t n){
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    for (; i < n; i++)
+        out[i] = x[i] * y[i];
+}
+
+void scale(const double* x, double factor, double* out, size_t n){
+    __m128d k = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), k));
+    for (; i < n; i++)
+        out[i] = x[i] * factor;
+}
+
+constexpr KernelTable table{sum, dot, min, max, add, mul, scale};
+
+}
+
+// The same kernels four lanes wide, compiled for AVX2 whatever the build's
+// target and only called when the processor has it.
+#define MINI_LISP_AVX2 __attribute__((target("avx2")))
+namespace avx2 {
+
+MINI_LISP_AVX2 double horizontal(__m256d v){
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+MINI_LISP_AVX2 double sum(const double* x, size_t n){
+    __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_add_pd(a, _mm256_loadu_pd(x + i));
+        b = _mm256_add_pd(b, _mm256_loadu_pd(x + i + 4));
+    }
+    double result = horizontal(_mm256_add_pd(a, b));
+    for (; i < n; i++)
+        result += x[i];
+    return result;
+}
+
+MINI_LISP_AVX2 double dot(const double* x, const double* y, size_t n){
+    __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_add_pd(a, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        b = _mm256_add_pd(b, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    double result = horizontal(_mm256_add_pd(a, b));
+    for (; i < n; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+MINI_LISP_AVX2 double min(const double* x, size_t n){
+    if (n < 4)
+        return sse2::min(x, n);
+    __m256d m = _mm256_loadu_pd(x);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4)
+        m = _mm256_min_pd(m, _mm256_loadu_pd(x + i));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, m);
+    double result = *std::min_element(lanes, lanes + 4);
+    for (; i < n; i++)
+        result = std::min(result, x[i]);
+    return result;
+}
+
+MINI_LISP_AVX2 double max(const double* x, size_t n){
+    if (n < 4)
+        return sse2::max(x, n);
+    __m256d m = _mm256_loadu_pd(x);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4)
+        m = _mm256_max_pd(m, _mm256_loadu_pd(x + i));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, m);
+    double result = *std::max_element(lanes, lanes + 4);
+    for (; i < n; i++)
+        result = std::max(result, x[i]);
+    return result;
+}
+
+MINI_LISP_AVX2 void add(const double* x, const double* y, double* out, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    for (; i < n; i++)
+        out[i] = x[i] + y[i];
+}
+
+MINI_LISP_AVX2 void mul(const double* x, const double* y, double* out, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    for (; i < n; i++)
+        out[i] = x[i] * y[i];
+}
+
+MINI_LISP_AVX2 void scale(const double* x, double factor, double* out, size_t n){
+    __m256d k = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), k));
+    for (; i < n; i++)
+        out[i] = x[i] * factor;
+}
+
+constexpr KernelTable table{sum, dot, min, max, add, mul, scale};
+
+}
+#undef MINI_LISP_AVX2
+
+#endif
+
+const KernelTable& kernels(){
+#ifdef MINI_LISP_X86_KERNELS
+    static const KernelTable& chosen = __builtin_cpu_supports("avx2") ? avx2::table : sse2::table;
+    return chosen;
+#else
+    return scalar::table;
+#endif
+}
+
+}
+
+double F64Kernels::sum(const double* x, size_t n){
+    return kernels().sum(x, n);
+}
+
+double F64Kernels::dot(const double* x, const double* y, size_t n){
+    return kernels().dot(x, y, n);
+}
+
+double F64Kernels::min(const double* x, size_t n){
+    return kernels().min(x, n);
+}
+
+double F64Kernels::max(const double* x, size_t n){
+    return kernels().max(x, n);
+}
+
+void F64Kernels::add(const double* x, const double* y, double* out, size_t n){
+    kernels().add(x, y, out, n);
+}
+
+void F64Kernels::mul(const double* x, const double* y, double* out, size_t n){
+    kernels().mul(x, y, out, n);
+}
+
+void F64Kernels::scale(const double* x, double factor, double* out, size_t n){
+    kernels().scale(x, factor, out, n);
+}
@@ -0,0 +1,24 @@
+#ifndef F64KERNELS_H
+#define F64KERNELS_H
+
+#include <cstddef>
+
+// Bulk operations on contiguous doubles, for f64vectors. On x86-64 with GCC
+// or clang each has an AVX2 and an SSE2 version, and the best one the
+// processor supports is picked on first use; elsewhere they are plain
+// loops. The reductions keep several partial sums at once, so they may
+// round differently from a left-to-right sum.
+class F64Kernels {
+public:
+    static double sum(const double* x, size_t n);
+    static double dot(const double* x, const double* y, size_t n);
+    // n must be at least 1.
+    static double min(const double* x, size_t n);
+    static double max(const double* x, size_t n);
+    // out may be the same array as an input.
+    static void add(const double* x, const double* y, double* out, size_t n);
+    static void mul(const double* x, const double* y, double* out, size_t n);
+    static void scale(const double* x, double factor, double* out, size_t n);
+};
+
+#endif
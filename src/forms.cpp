@@ -2,278 +2,269 @@
 #include "./error.h"
 #include "./builtin.h"
 
-using namespace std::literals;
-
-const std::unordered_map<std::string, SpecialFormType*> SPECIAL_FORMS{
-    {"define"s, defineForm},
-    {"quote"s, quoteForm},
-    {"quasiquote"s,quasiquoteForm},
-    {"if"s, ifForm},
-    {"and"s, andForm},
-    {"or"s, orForm},
-    {"lambda"s, lambdaForm},
-    {"cond"s, condForm},
-    {"case"s, caseForm},
-    {"let"s, letForm},
-    {"let*"s, letStarForm},
-    {"begin"s, beginForm},
-    {"delay"s, delayForm},
-    {"do"s, doForm}
+const std::unordered_map<Symbol, SpecialFormType*> SPECIAL_FORMS{
+    {Symbol::intern("define"), defineForm},
+    {Symbol::intern("quote"), quoteForm},
+    {Symbol::intern("quasiquote"),quasiquoteForm},
+    {Symbol::intern("if"), ifForm},
+    {Symbol::intern("and"), andForm},
+    {Symbol::intern("or"), orForm},
+    {Symbol::intern("lambda"), lambdaForm},
+    {Symbol::intern("cond"), condForm},
+    {Symbol::intern("case"), caseForm},
+    {Symbol::intern("let"), letForm},
+    {Symbol::intern("let*"), letStarForm},
+    {Symbol::intern("begin"), beginForm},
+    {Symbol::intern("delay"), delayForm},
+    {Symbol::intern("do"), doForm}
 };
 
-ValuePtr defineForm(const std::vector<ValuePtr>& args, EvalEnv& e) {
+static const Symbol ELSE = Symbol::intern("else");
+static const Symbol UNQUOTE = Symbol::intern("unquote");
+
+static bool isKeyword(const ValuePtr& value, Symbol keyword){
+    auto symbol = value.asSymbol();
+    return symbol && *symbol == keyword;
+}
+
+static std::vector<Symbol> paramNames(const ValuePtr& list){
+    std::vector<Symbol> result;
+    for(const auto& param : list.toVector()){
+        auto symbol = param.asSymbol();
+        if(!symbol)
+            throw LispError("Invalid parameter list");
+        result.push_back(*symbol);
+    }
+    return result;
+}
+
+static NodePtr lambda(const ValuePtr& params, const std::vector<ValuePtr>& args, Analyzer& a,
+                      std::optional<Symbol> name = std::nullopt){
+    auto names = paramNames(params);
+    size_t arity = names.size();
+    auto inner = a.enter(std::move(names));
+    auto body = inner.analyzeBody(args, 1);
+    return std::make_shared<LambdaNode>(inner.getScope(), arity, std::move(body), name);
+}
+
+// Splits one (name init) binding into its name and analyzed initializer.
+static void binding(const ValuePtr& def, Analyzer& a, std::vector<Symbol>& names, std::vector<NodePtr>& inits){
+    if(def.getType() != ValueType::PAIR)
+        throw LispError("Invalid definition");
+    std::vector<ValuePtr> parts = def.toVector();
+    if(parts.size() != 2) throw LispError("Invalid definition");
+    auto name = parts[0].asSymbol();
+    if(!name) throw LispError("Invalid definition");
+    names.push_back(*name);
+    inits.push_back(a.analyze(parts[1]));
+}
+
+NodePtr defineForm(const std::vector<ValuePtr>& args, Analyzer& a) {
     if (args.size() < 2) throw ArgumentError();
-    if (auto name = args[0]->asSymbol()) {
-        if (args[1]->getType() == ValueType::SYMBOL)
-            e.defineBinding(*name, args[1]);
-        e.defineBinding(*name, e.eval(args[1]));
-        return std::make_shared<NilValue>();
-    } 
-    else if (args[0]->getType() == ValueType::PAIR){
+    std::optional<Symbol> name;
+    ValuePtr params = nullptr;
+    if (name = args[0].asSymbol(); name) {
+        if (args.size() != 2) throw ArgumentError();
+    }
+    else if (args[0].getType() == ValueType::PAIR){
         auto Pair = static_cast<PairValue*>(args[0].get());
-        auto name = Pair->getCar()->asSymbol();
+        name = Pair->getCar().asSymbol();
         if(!name){throw LispError("Invalid procedure name");}
-        auto params = Pair->getCdr()->toVector();
-        std::vector<ValuePtr> body;
-        for (size_t i = 1; i < args.size(); i++)
-            body.push_back(args[i]);
-        e.defineBinding(*name, make_shared<LambdaValue>(params, body, e.shared_from_this()));
-        return std::make_shared<NilValue>();
+        params = Pair->getCdr();
     }
     else throw LispError("Malformed define form");
+    // Claim the slot before analyzing the value so it can refer to itself.
+    auto slot = a.declare(*name);
+    auto value = params ? lambda(params, args, a, name) : a.analyze(args[1]);
+    // (define f (lambda ...)) names the procedure too, for the profiler.
+    if (auto proc = std::dynamic_pointer_cast<const LambdaNode>(value); proc && !proc->isNamed())
+        value = std::make_shared<LambdaNode>(proc->getScope(), proc->getArity(), proc->getBody(), name);
+    if (slot)
+        return std::make_shared<LocalDefineNode>(*slot, std::move(value));
+    return std::make_shared<GlobalDefineNode>(*name, std::move(value));
 }
 
-ValuePtr quoteForm(const std::vector<ValuePtr>& args, EvalEnv& e) {
-    if (args.size() != 1) 
+NodePtr quoteForm(const std::vector<ValuePtr>& args, Analyzer&) {
+    if (args.size() != 1)
         throw ArgumentError();
-    return args[0];
+    return std::make_shared<ConstantNode>(args[0]);
 }
 
-ValuePtr ifForm(const std::vector<ValuePtr>& args, EvalEnv& e) {
+NodePtr ifForm(const std::vector<ValuePtr>& args, Analyzer& a) {
     if (args.size() != 3 && args.size() != 2)
         throw ArgumentError();
-    auto cond = e.eval(args[0]);
-    if(args.size() == 3){
-        if (cond->isBoolean()){
-            if(!static_cast<BooleanValue*>(cond.get())->getValue())
-                return e.eval(args[2]);
-        }
-        return e.eval(args[1]);
-    }
-    else {
-        if (cond->isBoolean()){
-            if(static_cast<BooleanValue*>(cond.get())->getValue())
-                return e.eval(args[1]);
-        }
-        else return std::make_shared<NilValue>();
-    }
-    return std::make_shared<NilValue>();
+    return std::make_shared<IfNode>(a.analyze(args[0]), a.analyze(args[1]),
+                                    args.size() == 3 ? a.analyze(args[2]) : nullptr);
 }
 
-ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& e){
-    if (args.size() == 0)
-        return std::make_shared<BooleanValue>(true); 
-    for (const auto& i: args){
-        if (auto val = e.eval(i); val->isBoolean()){
-            if (!static_cast<BooleanValue*>(val.get())->getValue()){
-                return std::make_shared<BooleanValue>(false);
-            }
-        }
-    }
-    return e.eval(args[args.size()-1]);
+NodePtr andForm(const std::vector<ValuePtr>& args, Analyzer& a){
+    return std::make_shared<AndNode>(a.analyzeAll(args));
 }
 
-ValuePtr orForm(const std::vector<ValuePtr>& args, EvalEnv& e){
-    if (args.size() == 0)
-        return std::make_shared<BooleanValue>(false); 
-    for (const auto& i: args){
-        auto val = e.eval(i);
-        if (val->isBoolean()){
-            if (!static_cast<BooleanValue*>(val.get())->getValue()) continue;
-        }
-        return val;
-    }
-    return e.eval(args[args.size()-1]);
+NodePtr orForm(const std::vector<ValuePtr>& args, Analyzer& a){
+    return std::make_shared<OrNode>(a.analyzeAll(args));
 }
 
-ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& e){
-    auto params = args[0]->toVector();
-    std::vector<ValuePtr> body;
-    for (size_t i = 1; i < args.size(); i++)
-        body.push_back(args[i]);
-    return make_shared<LambdaValue>(params, body, e.shared_from_this());
+NodePtr lambdaForm(const std::vector<ValuePtr>& args, Analyzer& a){
+    if (args.size() < 2)
+        throw ArgumentError();
+    return lambda(args[0], args, a);
 }
 
-ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& e){
-    for(size_t i = 0; i < args.size(); i++){
-        auto Pair = static_cast<PairValue*>(args[i].get());
-        std::vector<ValuePtr> PairVec = Pair->toVector();
-        if (PairVec.size() == 1){return e.eval(PairVec[0]);}
-        if(PairVec[0]->asSymbol() && *PairVec[0]->asSymbol() == "else"s){
-            if(i == args.size() - 1)
-                return e.eval(PairVec[1]);
-            else throw LispError("Else clause not last in cond form");
+// cond is rewritten into nested ifs; a clause with only a test yields the
+// test's value, which is exactly what or does.
+NodePtr condForm(const std::vector<ValuePtr>& args, Analyzer& a){
+    NodePtr result = nullptr;
+    for(size_t i = args.size(); i-- > 0;){
+        if(args[i].getType() != ValueType::PAIR)
+            throw LispError("Invalid cond form, malformed clause");
+        std::vector<ValuePtr> clause = args[i].toVector();
+        if(isKeyword(clause[0], ELSE)){
+            if(i != args.size() - 1)
+                throw LispError("Else clause not last in cond form");
+            if(clause.size() < 2)
+                throw LispError("Invalid cond form, empty else clause");
+            result = a.analyzeBody(clause, 1);
         }
-        auto cond = e.eval(PairVec[0]);
-        if (cond->isBoolean() && !static_cast<BooleanValue*>(cond.get())->getValue()) continue;
-        else {
-            ValuePtr result = nullptr;
-            return e.eval(PairVec[1]);  
+        else if(clause.size() == 1){
+            std::vector<NodePtr> operands{a.analyze(clause[0])};
+            if(result) operands.push_back(result);
+            result = std::make_shared<OrNode>(std::move(operands));
         }
-    } 
-    return std::make_shared<NilValue>();
+        else result = std::make_shared<IfNode>(a.analyze(clause[0]), a.analyzeBody(clause, 1), result);
+    }
+    if(!result)
+        return std::make_shared<ConstantNode>(ValuePtr::nil());
+    return result;
 }
 
-ValuePtr caseForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+NodePtr caseForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if(args.size() < 2) throw ArgumentError();
-    auto key = e.eval(args[0]);
+    std::vector<CaseNode::Clause> clauses;
+    NodePtr elseBody = nullptr;
     for(size_t i = 1; i < args.size(); i++){
-        if(args[i]->getType() != ValueType::PAIR) throw LispError("Invalid case form, malformed clause");
-        auto branchPair = static_cast<PairValue*>(args[i].get());
-        std::vector<ValuePtr> branch = branchPair->toVector();
+        if(args[i].getType() != ValueType::PAIR) throw LispError("Invalid case form, malformed clause");
+        std::vector<ValuePtr> branch = args[i].toVector();
+        if(branch.size() < 2) throw LispError("Invalid case form, malformed clause");
         auto datum = branch[0];
-        if(datum->asSymbol() && *datum->asSymbol() == "else"s){
-            if(i == args.size()-1){
-                ValuePtr result = nullptr;
-                for(size_t j = 1; j < branch.size(); j++)
-                    result = e.eval(branch[j]);
-                return result;
-            }
-            else throw LispError("Else clause not last in case form");
-        }
-        if(datum->getType() != ValueType::PAIR) throw LispError("Invalid case form, malformed clause");
-        auto literalPair = static_cast<PairValue*>(datum.get())->toVector();
-        if(literalPair.size() != 1) throw LispError("Invalid case form, incorrect number of literals");
-        auto literal = literalPair[0];
-        if(!literal->isAtom()) throw LispError("Invalid case form, datum not a literal");
-        if(static_cast<BooleanValue*>(equal({key, literal}, e).get())->getValue()){
-            ValuePtr result = nullptr;
-            for(size_t j = 1; j < branch.size(); j++)
-                result = e.eval(branch[j]);
-            return result;
+        if(isKeyword(datum, ELSE)){
+            if(i != args.size()-1) throw LispError("Else clause not last in case form");
+            elseBody = a.analyzeBody(branch, 1);
+            continue;
         }
+        if(datum.getType() != ValueType::PAIR) throw LispError("Invalid case form, malformed clause");
+        auto literals = datum.toVector();
+        for(const auto& literal : literals)
+            if(!literal.isAtom()) throw LispError("Invalid case form, datum not a literal");
+        clauses.push_back({std::move(literals), a.analyzeBody(branch, 1)});
     }
-    return std::make_shared<NilValue>();
+    return std::make_shared<CaseNode>(a.analyze(args[0]), std::move(clauses), std::move(elseBody));
 }
 
-ValuePtr letForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+NodePtr letForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if (args.size() < 2){
         throw ArgumentError();
     }
-    std::vector<ValuePtr> vars;    
-    std::vector<ValuePtr> vals;
-    std::vector<ValuePtr> definitions = args[0]->toVector();    
-    for (const auto& i: definitions){
-        if(i->getType() != ValueType::PAIR){
-            throw LispError("Invalid definition");
-        }
-        auto Pair = static_cast<PairValue*>(i.get());
-        std::vector<ValuePtr> def = Pair->toVector();   
-        if(def.size() != 2) throw LispError("Invalid definition");
-        vars.push_back(def[0]);
-        vals.push_back(e.eval(def[1]));
-    }
-    std::vector<ValuePtr> body(args.begin() + 1, args.end());
-    auto lambda = std::make_shared<LambdaValue>(vars, body, e.shared_from_this());
-    return lambda.get()->apply(vals);   
+    std::vector<Symbol> names;
+    std::vector<NodePtr> inits;
+    for(const auto& def : args[0].toVector())
+        binding(def, a, names, inits);
+    auto inner = a.enter(std::move(names));
+    auto body = inner.analyzeBody(args, 1);
+    return std::make_shared<LetNode>(inner.getScope(), std::move(inits), std::move(body));
 }
 
-ValuePtr letStarForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+// let* is a chain of single-binding lets, so each initializer is analyzed
+// in a scope that already sees the bindings before it.
+static NodePtr letStar(const std::vector<ValuePtr>& definitions, size_t index, const std::vector<ValuePtr>& args, Analyzer& a){
+    std::vector<Symbol> names;
+    std::vector<NodePtr> inits;
+    binding(definitions[index], a, names, inits);
+    auto inner = a.enter(std::move(names));
+    auto body = index + 1 == definitions.size() ? inner.analyzeBody(args, 1)
+                                                : letStar(definitions, index + 1, args, inner);
+    return std::make_shared<LetNode>(inner.getScope(), std::move(inits), std::move(body));
+}
+
+NodePtr letStarForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if (args.size() < 2){
         throw ArgumentError();
     }
-    std::vector<ValuePtr> vars;    
-    std::vector<ValuePtr> vals;
-    std::vector<ValuePtr> definitions = args[0]->toVector();    
-    auto child = e.shared_from_this();
-    for (const auto& i: definitions){
-        if(i->getType() != ValueType::PAIR){
-            throw LispError("Invalid definition");
-        }
-        auto Pair = static_cast<PairValue*>(i.get());
-        std::vector<ValuePtr> def = Pair->toVector();   
-        if(def.size() != 2) throw LispError("Invalid definition");
-        vars.push_back(def[0]);
-        vals.push_back(child->eval(def[1]));
-        child = child->createChild({*def[0]->asSymbol()}, {vals.back()});
-    }
-    std::vector<ValuePtr> body(args.begin() + 1, args.end());
-    auto lambda = std::make_shared<LambdaValue>(vars, body, child);
-    return lambda.get()->apply(vals);   
+    auto definitions = args[0].toVector();
+    if(definitions.empty())
+        return letForm(args, a);
+    return letStar(definitions, 0, args, a);
+}
+
+NodePtr beginForm(const std::vector<ValuePtr>& args, Analyzer& a){
+    return std::make_shared<SequenceNode>(a.analyzeAll(args));
 }
 
-ValuePtr beginForm(const std::vector<ValuePtr>& args, EvalEnv& e){
-    ValuePtr result = nullptr;
-    for (const auto& i: args){
-        result = e.eval(i);
+// Null when expr has nothing unquoted in it and can be used as it is; an
+// unquote that analyzes to a constant still has to replace its form.
+static NodePtr quasiquote(const ValuePtr& expr, Analyzer& a){
+    if(expr.getType() != ValueType::PAIR)
+        return nullptr;
+    auto Pair = static_cast<PairValue*>(expr.get());
+    if(isKeyword(Pair->getCar(), UNQUOTE)){
+        std::vector<ValuePtr> PairVec = Pair->toVector();
+        if(PairVec.size() != 2)
+            throw LispError("Invalid unquote form");
+        return a.analyze(PairVec[1]);
     }
-    return result;
+    auto car = quasiquote(Pair->getCar(), a);
+    auto cdr = quasiquote(Pair->getCdr(), a);
+    if(!car && !cdr)
+        return nullptr;
+    if(!car)
+        car = std::make_shared<ConstantNode>(Pair->getCar());
+    if(!cdr)
+        cdr = std::make_shared<ConstantNode>(Pair->getCdr());
+    return std::make_shared<ConsNode>(std::move(car), std::move(cdr));
 }
 
-ValuePtr quasiquoteForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+NodePtr quasiquoteForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if(args.size() != 1)
         throw ArgumentError();
-    if(args[0]->getType() != ValueType::PAIR)
-        return args[0];
-    auto exprPair = static_cast<PairValue*>(args[0].get());
-    std::vector<ValuePtr> newArgs;
-    for(const auto& arg : exprPair->toVector()){
-        if(arg->getType() == ValueType::PAIR){
-            auto Pair = static_cast<PairValue*>(arg.get());
-            std::vector<ValuePtr> PairVec = Pair->toVector();
-            if(PairVec.size() > 0 && PairVec[0]->asSymbol() && *PairVec[0]->asSymbol() == "unquote"s){
-                if(PairVec.size() != 2)
-                    throw LispError("Invalid unquote form");
-                newArgs.push_back(e.eval(PairVec[1]));
-            }
-            else newArgs.push_back(arg);
-        }
-        else newArgs.push_back(arg);
-    }
-    return makelist(newArgs, e);
+    if(auto node = quasiquote(args[0], a))
+        return node;
+    return std::make_shared<ConstantNode>(args[0]);
 }
 
-ValuePtr delayForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+NodePtr delayForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if(args.size() != 1)
         throw ArgumentError();
-    return make_shared<PromiseValue>(args[0], e.shared_from_this());
+    auto inner = a.enter({});
+    auto expr = inner.analyze(args[0]);
+    return std::make_shared<DelayNode>(std::make_shared<LambdaNode>(inner.getScope(), 0, std::move(expr)));
 }
 
-ValuePtr doForm(const std::vector<ValuePtr>& args, EvalEnv& e){
+NodePtr doForm(const std::vector<ValuePtr>& args, Analyzer& a){
     if(args.size() < 2)
         throw ArgumentError();
-    auto varList = static_cast<PairValue*>(args[0].get())->toVector();
-    std::vector<std::string> names; std::vector<ValuePtr> inits; std::vector<ValuePtr> steps;
-    for(const auto& i: varList){
-        if(i->getType() != ValueType::PAIR)
+    std::vector<Symbol> names; std::vector<NodePtr> inits; std::vector<ValuePtr> steps;
+    for(const auto& i: args[0].toVector()){
+        if(i.getType() != ValueType::PAIR)
             throw LispError("Invalid variable list");
-        auto wholeVar = static_cast<PairValue*>(i.get())->toVector();
-        if(wholeVar.size() != 3)
+        auto wholeVar = i.toVector();
+        if(wholeVar.size() != 2 && wholeVar.size() != 3)
             throw LispError("Invalid variable list");
-        if(wholeVar[0]->getType() != ValueType::SYMBOL)
+        if(wholeVar[0].getType() != ValueType::SYMBOL)
             throw LispError("Invalid variable name");
-        names.push_back(*wholeVar[0]->asSymbol());
-        inits.push_back(wholeVar[1]);
-        steps.push_back(wholeVar[2]);
+        names.push_back(*wholeVar[0].asSymbol());
+        inits.push_back(a.analyze(wholeVar[1]));
+        steps.push_back(wholeVar.size() == 3 ? wholeVar[2] : nullptr);
     }
-    if(args[1]->getType() != ValueType::PAIR)
+    if(args[1].getType() != ValueType::PAIR)
         throw LispError("Invalid test clause in do form");
-    auto test = static_cast<PairValue*>(args[1].get())->toVector();
-    auto body = std::vector<ValuePtr>(args.begin() + 2, args.end());
-    auto child = e.createChild(names, inits);
-    while(true){
-        auto testResult = child->eval(test[0]);
-        if(testResult->getType() != ValueType::BOOLEAN)
-            throw LispError("Invalid test clause in do form");
-        if(static_cast<BooleanValue*>(testResult.get())->getValue()){
-            ValuePtr result = std::make_shared<NilValue>();
-            for(size_t i = 1; i < test.size(); i++)
-                result = child->eval(test[i]);
-            return result;
-        }
-        for(const auto& i: body)
-            child->eval(i);
-        for(size_t i = 0; i < names.size(); i++)
-            child->defineBinding(names[i], child->eval(steps[i]));  
-    }
-}
\ No newline at end of file
+    auto test = args[1].toVector();
+    auto inner = a.enter(std::move(names));
+    auto body = inner.analyzeBody(args, 2);
+    std::vector<NodePtr> stepNodes;
+    for(const auto& step : steps)
+        stepNodes.push_back(step ? inner.analyze(step) : nullptr);
+    return std::make_shared<DoNode>(inner.getScope(), std::move(inits), std::move(stepNodes),
+                                    inner.analyze(test[0]),
+                                    std::make_shared<SequenceNode>(inner.analyzeAll(test, 1)),
+                                    std::move(body));
+}
@@ -1,25 +1,26 @@
 #ifndef FORMS_H
 #define FORMS_H
 
-#include "./eval_env.h"
+#include "./analyzer.h"
 #include "./error.h"
+#include <unordered_map>
 
-using SpecialFormType = ValuePtr(const std::vector<ValuePtr>&, EvalEnv&);
-extern const std::unordered_map<std::string, SpecialFormType*> SPECIAL_FORMS;
+using SpecialFormType = NodePtr(const std::vector<ValuePtr>&, Analyzer&);
+extern const std::unordered_map<Symbol, SpecialFormType*> SPECIAL_FORMS;
 
-ValuePtr defineForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr quoteForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr ifForm(const std::vector<ValuePtr>& args, EvalEnv& env);   
-ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr orForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr caseForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr letForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr letStarForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr beginForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr quasiquoteForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr delayForm(const std::vector<ValuePtr>& args, EvalEnv& env);
-ValuePtr doForm(const std::vector<ValuePtr>& args, EvalEnv& env);   
+NodePtr defineForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr quoteForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr ifForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr andForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr orForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr lambdaForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr condForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr caseForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr letForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr letStarForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr beginForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr quasiquoteForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr delayForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
+NodePtr doForm(const std::vector<ValuePtr>& args, Analyzer& analyzer);
 
-#endif
\ No newline at end of file
+#endif
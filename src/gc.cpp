@@ -0,0 +1,138 @@
+#include "./gc.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+// Never destroyed, so objects owned by other statics can still untrack
+// themselves during shutdown.
+static std::vector<GcObject*>& registry(){
+    static auto objects = new std::vector<GcObject*>();
+    return *objects;
+}
+
+// Objects whose last reference was dropped while another was being
+// deleted, waiting for Heap::destroy to get to them.
+static std::vector<GcObject*>& released(){
+    static auto objects = new std::vector<GcObject*>();
+    return *objects;
+}
+
+static GcStats gcStats;
+
+// Collections never run more often than this many allocations apart.
+static constexpr size_t MIN_THRESHOLD = 100000;
+
+GcObject::GcObject() {
+    Heap::track(this);
+}
+
+GcObject::~GcObject() {
+    Heap::untrack(this);
+}
+
+void Heap::track(GcObject* object){
+    auto& objects = registry();
+    object->index = static_cast<uint32_t>(objects.size());
+    objects.push_back(object);
+}
+
+void Heap::untrack(GcObject* object){
+    auto& objects = registry();
+    auto last = objects.back();
+    objects[object->index] = last;
+    last->index = object->index;
+    objects.pop_back();
+}
+
+void Heap::destroy(GcObject* object){
+    auto& pending = released();
+    if (destroying) {
+        pending.push_back(object);
+        return;
+    }
+    destroying = true;
+    delete object;
+    while (!pending.empty()) {
+        auto next = pending.back();
+        pending.pop_back();
+        delete next;
+    }
+    destroying = false;
+}
+
+size_t Heap::size(){
+    return registry().size();
+}
+
+const GcStats& Heap::stats(){
+    return gcStats;
+}
+
+size_t Heap::collect(){
+    auto start = std::chrono::steady_clock::now();
+    auto& objects = registry();
+    // gcRefs starts as the reference count and loses one for every
+    // reference held by another heap object, leaving the references from
+    // outside. An object nothing counts yet is still being built; it is
+    // kept like a root.
+    constexpr int64_t REACHABLE = std::numeric_limits<int64_t>::min();
+    for (auto object : objects)
+        object->gcRefs = object->refs == 0 ? 1 : object->refs;
+
+    class Unref : public Tracer {
+    public:
+        void visit(GcObject* object) override {
+            if (object)
+                object->gcRefs--;
+        }
+    } unref;
+    for (auto object : objects)
+        object->trace(unref);
+
+    class Mark : public Tracer {
+    public:
+        std::vector<GcObject*> pending;
+        void visit(GcObject* object) override {
+            if (object && object->gcRefs != REACHABLE) {
+                object->gcRefs = REACHABLE;
+                pending.push_back(object);
+            }
+        }
+    } mark;
+    for (auto object : objects) {
+        if (object->gcRefs <= 0)
+            continue;
+        mark.visit(object);
+        while (!mark.pending.empty()) {
+            auto next = mark.pending.back();
+            mark.pending.pop_back();
+            next->trace(mark);
+        }
+    }
+
+    // What is left is referenced only from other garbage. Holding an extra
+    // reference to all of it while the references between them are
+    // cleared keeps any of it from being freed halfway through.
+    std::vector<GcObject*> garbage;
+    for (auto object : objects)
+        if (object->gcRefs != REACHABLE)
+            garbage.push_back(object);
+    for (auto object : garbage)
+        object->refs++;
+    for (auto object : garbage)
+        object->clearReferences();
+    for (auto object : garbage)
+        if (--object->refs == 0)
+            destroy(object);
+
+    sinceCollection = 0;
+    threshold = std::max(MIN_THRESHOLD, objects.size());
+    std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+    gcStats.collections++;
+    gcStats.freed += garbage.size();
+    gcStats.lastPauseMs = pause.count();
+    gcStats.totalPauseMs += pause.count();
+    gcStats.maxPauseMs = std::max(gcStats.maxPauseMs, pause.count());
+    return garbage.size();
+}
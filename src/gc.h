@@ -0,0 +1,130 @@
+#ifndef GC_H
+#define GC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "./pool.h"
+
+class GcObject;
+
+// Receives every reference one heap object holds to another.
+class Tracer {
+public:
+    virtual ~Tracer() = default;
+    // Null references are ignored, so callers can pass immediates through.
+    virtual void visit(GcObject* object) = 0;
+};
+
+// Everything on the collected heap: Values and environments. Objects are
+// reference counted, which frees most garbage the moment it is dropped;
+// the heap also keeps a registry of every live object so that cycles,
+// which reference counting alone never frees, can be found by tracing.
+class GcObject {
+private:
+    mutable uint32_t refs = 0;
+    uint32_t index;
+    int64_t gcRefs = 0;
+    friend class Heap;
+    friend class ValuePtr;
+    template <typename T> friend class GcRef;
+protected:
+    GcObject();
+public:
+    GcObject(const GcObject&) = delete;
+    GcObject& operator=(const GcObject&) = delete;
+    virtual ~GcObject();
+
+    // Heap objects are small and short-lived; they come from the pools.
+    static void* operator new(size_t size) {return Pool::allocate(size);}
+    static void operator delete(void* block, size_t size) {Pool::deallocate(block, size);}
+
+    // Report each counted reference to another heap object, and drop them
+    // all; a collection uses these to take unreachable cycles apart.
+    virtual void trace(Tracer& tracer) const {}
+    virtual void clearReferences() {}
+};
+
+struct GcStats {
+    size_t collections = 0;
+    size_t freed = 0;
+    double lastPauseMs = 0;
+    double totalPauseMs = 0;
+    double maxPauseMs = 0;
+};
+
+// The registry of live heap objects and the cycle collector over it.
+//
+// There is no way to enumerate the references C++ code holds on its own
+// stack, so roots are found the way a trial-deletion collector finds them:
+// each object's count of references from other heap objects is subtracted
+// from its reference count, and anything left with references over is held
+// from outside the heap. Everything traced from those roots is live; the
+// rest is garbage held only by cycles, and is freed by clearing its
+// references. This is safe to run at any allocation.
+class Heap {
+public:
+    static size_t size();
+    static const GcStats& stats();
+    // Runs a full collection and returns the number of objects freed.
+    static size_t collect();
+    // Called after each allocation; collects once enough allocations have
+    // happened since the last collection to be worth a pass over the heap.
+    static void allocated() {
+        if (++sinceCollection >= threshold)
+            collect();
+    }
+    // Deletes an object whose last reference was just dropped. Objects it
+    // frees in turn are queued and deleted in a loop once it is gone, so
+    // dropping a list a million pairs long takes no more stack than
+    // dropping one pair.
+    static void destroy(GcObject* object);
+private:
+    static inline size_t sinceCollection = 0;
+    static inline bool destroying = false;
+    static inline size_t threshold = 100000;
+    static void track(GcObject* object);
+    static void untrack(GcObject* object);
+    friend class GcObject;
+};
+
+// An owning, reference-counting pointer to a heap object other than a Value.
+template <typename T>
+class GcRef {
+private:
+    T* object;
+    void retain() const {if (object) object->refs++;}
+    void release() const {
+        if (object && --object->refs == 0)
+            Heap::destroy(object);
+    }
+public:
+    GcRef(std::nullptr_t = nullptr) : object{nullptr} {}
+    explicit GcRef(T* object) : object{object} {retain();}
+    GcRef(const GcRef& other) : object{other.object} {retain();}
+    GcRef(GcRef&& other) noexcept : object{other.object} {other.object = nullptr;}
+    // other may be owned by the object being released, so it is read first.
+    GcRef& operator=(const GcRef& other) {
+        T* next = other.object;
+        other.retain();
+        release();
+        object = next;
+        return *this;
+    }
+    GcRef& operator=(GcRef&& other) noexcept {
+        if (this != &other) {
+            T* next = std::exchange(other.object, nullptr);
+            release();
+            object = next;
+        }
+        return *this;
+    }
+    ~GcRef() {release();}
+
+    T* get() const {return object;}
+    T* operator->() const {return object;}
+    T& operator*() const {return *object;}
+    explicit operator bool() const {return object != nullptr;}
+};
+
+#endif
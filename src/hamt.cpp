@@ -0,0 +1,228 @@
+#include "./hamt.h"
+#include "./equality.h"
+#include <bit>
+
+namespace {
+
+constexpr unsigned BITS = 5;
+constexpr uint64_t MASK = (1u << BITS) - 1;
+
+using NodeRef = GcRef<HamtNode>;
+
+uint32_t bitFor(uint64_t hash, unsigned shift){
+    return 1u << ((hash >> shift) & MASK);
+}
+
+size_t indexOf(uint32_t bitmap, uint32_t bit){
+    return static_cast<size_t>(std::popcount(bitmap & (bit - 1)));
+}
+
+NodeRef makeNode(uint32_t bitmap, std::vector<HamtEntry> entries){
+    NodeRef node(new HamtNode);
+    node->bitmap = bitmap;
+    node->entries = std::move(entries);
+    Heap::allocated();
+    return node;
+}
+
+// A node holding two keys that share every hash bit below shift.
+NodeRef makePair(unsigned shift, HamtEntry first, HamtEntry second){
+    if (first.hash == second.hash)
+        return makeNode(0, {std::move(first), std::move(second)});
+    uint32_t firstBit = bitFor(first.hash, shift);
+    uint32_t secondBit = bitFor(second.hash, shift);
+    if (firstBit == secondBit) {
+        HamtEntry entry;
+        entry.child = makePair(shift + BITS, std::move(first), std::move(second));
+        return makeNode(firstBit, {std::move(entry)});
+    }
+    if (firstBit > secondBit)
+        std::swap(first, second);
+    return makeNode(firstBit | secondBit, {std::move(first), std::move(second)});
+}
+
+NodeRef assoc(const NodeRef& node, unsigned shift, HamtEntry leaf, bool& added){
+    if (!node) {
+        added = true;
+        return makeNode(bitFor(leaf.hash, shift), {std::move(leaf)});
+    }
+    if (node->isCollision()) {
+        uint64_t hash = node->entries[0].hash;
+        if (leaf.hash != hash) {
+            // Nest the collision under a node that tells the hashes apart.
+            HamtEntry entry;
+            entry.child = node;
+            return assoc(makeNode(bitFor(hash, shift), {std::move(entry)}), shift, std::move(leaf), added);
+        }
+        auto entries = node->entries;
+        for (auto& entry : entries) {
+            if (Equality::equal(entry.key, leaf.key)) {
+                if (entry.value == leaf.value)
+                    return node;
+                entry.value = std::move(leaf.value);
+                return makeNode(0, std::move(entries));
+            }
+        }
+        added = true;
+        entries.push_back(std::move(leaf));
+        return makeNode(0, std::move(entries));
+    }
+    uint32_t bit = bitFor(leaf.hash, shift);
+    size_t index = indexOf(node->bitmap, bit);
+    if (!(node->bitmap & bit)) {
+        added = true;
+        auto entries = node->entries;
+        entries.insert(entries.begin() + index, std::move(leaf));
+        return makeNode(node->bitmap | bit, std::move(entries));
+    }
+    const auto& existing = node->entries[index];
+    HamtEntry replacement;
+    if (existing.child) {
+        replacement.child = assoc(existing.child, shift + BITS, std::move(leaf), added);
+        if (replacement.child.get() == existing.child.get())
+            return node;
+    } else if (existing.hash == leaf.hash && Equality::equal(existing.key, leaf.key)) {
+        if (existing.value == leaf.value)
+            return node;
+        replacement = existing;
+        replacement.value = std::move(leaf.value);
+    } else {
+        added = true;
+        replacement.child = makePair(shift + BITS, existing, std::move(leaf));
+    }
+    auto entries = node->entries;
+    entries[index] = std::move(replacement);
+    return makeNode(node->bitmap, std::move(entries));
+}
+
+NodeRef dissoc(const NodeRef& node, unsigned shift, uint64_t hash, const ValuePtr& key, bool& removed){
+    if (node->isCollision()) {
+        for (size_t i = 0; i < node->entries.size(); i++) {
+            if (Equality::equal(node->entries[i].key, key)) {
+                removed = true;
+                if (node->entries.size() == 1)
+                    return nullptr;
+                auto entries = node->entries;
+                entries.erase(entries.begin() + i);
+                return makeNode(0, std::move(entries));
+            }
+        }
+        return node;
+    }
+    uint32_t bit = bitFor(hash, shift);
+    if (!(node->bitmap & bit))
+        return node;
+    size_t index = indexOf(node->bitmap, bit);
+    const auto& existing = node->entries[index];
+    NodeRef child;
+    if (existing.child) {
+        child = dissoc(existing.child, shift + BITS, hash, key, removed);
+        if (child.get() == existing.child.get())
+            return node;
+    } else if (existing.hash != hash || !Equality::equal(existing.key, key)) {
+        return node;
+    } else {
+        removed = true;
+    }
+    auto entries = node->entries;
+    if (!child) {
+        if (entries.size() == 1)
+            return nullptr;
+        entries.erase(entries.begin() + index);
+        return makeNode(node->bitmap & ~bit, std::move(entries));
+    }
+    // A child left with a single key is folded back into this node.
+    if (child->entries.size() == 1 && !child->entries[0].child)
+        entries[index] = child->entries[0];
+    else
+        entries[index] = {0, nullptr, nullptr, std::move(child)};
+    return makeNode(node->bitmap, std::move(entries));
+}
+
+}
+
+void HamtNode::trace(Tracer& tracer) const {
+    for (const auto& entry : entries) {
+        tracer.visit(entry.key.get());
+        tracer.visit(entry.value.get());
+        tracer.visit(entry.child.get());
+    }
+}
+
+void HamtNode::clearReferences() {
+    entries.clear();
+}
+
+const ValuePtr* PersistentMapValue::find(const ValuePtr& key) const {
+    uint64_t hash = Equality::hashEqual(key);
+    const HamtNode* node = root.get();
+    unsigned shift = 0;
+    while (node) {
+        if (node->isCollision()) {
+            for (const auto& entry : node->entries)
+                if (entry.hash == hash && Equality::equal(entry.key, key))
+                    return &entry.value;
+            return nullptr;
+        }
+        uint32_t bit = bitFor(hash, shift);
+        if (!(node->bitmap & bit))
+            return nullptr;
+        const auto& entry = node->entries[indexOf(node->bitmap, bit)];
+        if (!entry.child)
+            return entry.hash == hash && Equality::equal(entry.key, key) ? &entry.value : nullptr;
+        node = entry.child.get();
+        shift += BITS;
+    }
+    return nullptr;
+}
+
+ValuePtr PersistentMapValue::assoc(const ValuePtr& key, ValuePtr value) const {
+    bool added = false;
+    auto next = ::assoc(root, 0, {Equality::hashEqual(key), key, std::move(value), nullptr}, added);
+    if (next.get() == root.get())
+        return ValuePtr(const_cast<PersistentMapValue*>(this));
+    return makeValue<PersistentMapValue>(getType(), std::move(next), count + added);
+}
+
+ValuePtr PersistentMapValue::dissoc(const ValuePtr& key) const {
+    bool removed = false;
+    auto next = root ? ::dissoc(root, 0, Equality::hashEqual(key), key, removed) : nullptr;
+    if (!removed)
+        return ValuePtr(const_cast<PersistentMapValue*>(this));
+    return makeValue<PersistentMapValue>(getType(), std::move(next), count - 1);
+}
+
+// Summing the entries' hashes makes the result independent of their order,
+// which differs between equal maps only inside collision nodes.
+size_t PersistentMapValue::contentHash() const {
+    if (!hash) {
+        size_t sum = count;
+        forEach([&](const HamtEntry& entry){
+            sum += entry.hash * 31 + (isSet() ? 0 : Equality::hashEqual(entry.value));
+        });
+        hash = sum;
+    }
+    return *hash;
+}
+
+std::string PersistentMapValue::toString() const {
+    std::string result = isSet() ? "#{" : "{";
+    bool first = true;
+    forEach([&](const HamtEntry& entry){
+        if (!first)
+            result += isSet() ? " " : ", ";
+        first = false;
+        result += entry.key.toString();
+        if (!isSet())
+            result += " " + entry.value.toString();
+    });
+    return result + "}";
+}
+
+void PersistentMapValue::trace(Tracer& tracer) const {
+    tracer.visit(root.get());
+}
+
+void PersistentMapValue::clearReferences() {
+    root = nullptr;
+}
@@ -0,0 +1,80 @@
+#ifndef HAMT_H
+#define HAMT_H
+
+#include "./value.h"
+#include <cstdint>
+#include <vector>
+
+class HamtNode;
+
+// One slot of a HamtNode: a key and its value, or a child node that holds
+// every key whose hash continues differently.
+struct HamtEntry {
+    uint64_t hash = 0;
+    ValuePtr key;
+    ValuePtr value;
+    GcRef<HamtNode> child;
+};
+
+// A node of a hash array mapped trie. Each level takes the next five bits
+// of a key's hash; bitmap has a bit set for each of the 32 possible slots
+// in use, and entries holds only those, in order. A node whose bitmap is 0
+// holds keys whose whole hashes are the same, compared one by one. Nodes
+// are never changed once built, so maps share every node an update does
+// not touch.
+class HamtNode : public GcObject {
+public:
+    uint32_t bitmap = 0;
+    std::vector<HamtEntry> entries;
+
+    bool isCollision() const {return bitmap == 0;}
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+};
+
+// A persistent map, or a set when its type is PSET, keyed by equal?. Every
+// update returns a new map that shares all but the O(log32 n) nodes on the
+// path to the key with the old one, which is left as it was.
+class PersistentMapValue : public Value {
+private:
+    GcRef<HamtNode> root;
+    size_t count;
+    mutable std::optional<size_t> hash;
+
+    template <typename F>
+    static void forEachIn(const HamtNode& node, F& f) {
+        for (const auto& entry : node.entries) {
+            if (entry.child)
+                forEachIn(*entry.child, f);
+            else
+                f(entry);
+        }
+    }
+public:
+    PersistentMapValue(ValueType type, GcRef<HamtNode> root = nullptr, size_t count = 0)
+        : Value(type), root{std::move(root)}, count{count} {}
+
+    bool isSet() const {return getType() == ValueType::PSET;}
+    size_t size() const {return count;}
+    // The value stored under key, or null.
+    const ValuePtr* find(const ValuePtr& key) const;
+    // This map with key bound to value, or this map itself when it already was.
+    ValuePtr assoc(const ValuePtr& key, ValuePtr value) const;
+    // This map without key, or this map itself when it had no such key.
+    ValuePtr dissoc(const ValuePtr& key) const;
+    // Calls f on each key's HamtEntry, in no particular order.
+    template <typename F>
+    void forEach(F f) const {
+        if (root)
+            forEachIn(*root, f);
+    }
+    // The same for maps with equal? contents, whatever order their keys
+    // were added in; computed once, since the map never changes.
+    size_t contentHash() const;
+
+    std::string toString() const override;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+};
+
+#endif
@@ -0,0 +1,507 @@
+#include "./jit.h"
+#include "./analyzer.h"
+#include "./builtin.h"
+#include <array>
+#include <cstring>
+
+#ifdef MINI_LISP_JIT
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// Calls a lambda gets in the interpreter before it is compiled.
+constexpr uint32_t HOT_CALLS = 10;
+// Bail-outs after which its native code is given up on.
+constexpr size_t MAX_BAILS = 64;
+constexpr size_t MAX_ARITY = 16;
+// Native recursion bails out once it has used this much machine stack, so
+// deep recursion is left to the interpreter.
+constexpr int32_t STACK_LIMIT = 512 * 1024;
+
+// The builtins native code implements itself, for int64 operands.
+const std::array<std::string, 12> PRIMITIVES{
+    "+", "-", "*", "=", "<", ">", "<=", ">=", "not", "zero?", "quotient", "remainder"};
+
+// Second opcode bytes of the conditional forms after 0F.
+constexpr uint8_t OVERFLOW = 0x80, BELOW = 0x82, EQUAL = 0x84, NOT_EQUAL = 0x85;
+
+// Globals of a lambda body resolve in the frame its definition was
+// evaluated in: the innermost ancestor that is not a local frame.
+EvalEnv& globalFrame(const LambdaValue& lambda){
+    EvalEnv* frame = lambda.getParent().get();
+    while (frame->getScope())
+        frame = frame->getParent().get();
+    return *frame;
+}
+
+bool isSelf(const ValuePtr& value, const LambdaNode& lambda){
+    return value.getType() == ValueType::LAMBDA
+        && static_cast<LambdaValue*>(value.get())->getCode().get() == &lambda;
+}
+
+}
+
+NativeCode::~NativeCode(){
+#ifdef MINI_LISP_JIT
+    if (memory)
+        munmap(memory, size);
+#endif
+}
+
+bool Jit::enable(){
+#ifdef MINI_LISP_JIT
+    on = true;
+#endif
+    return on;
+}
+
+ValuePtr Jit::call(const LambdaValue& lambda, ValueSpan args){
+    const auto& node = *lambda.getCode();
+    if (args.size() != node.getArity() || args.size() > MAX_ARITY)
+        return nullptr;
+    EvalEnv& global = globalFrame(lambda);
+    NativeCode* native = node.hotCode(global);
+    if (!native || !native->entry)
+        return nullptr;
+    int64_t raw[MAX_ARITY];
+    for (size_t i = 0; i < args.size(); i++) {
+        if (!args[i].isInt64())
+            return nullptr;
+        raw[i] = args[i].asInteger();
+    }
+    for (auto& guard : native->guards) {
+        const ValuePtr* value;
+        try {
+            value = &global.lookupGlobal(guard.name, 0, guard.cache);
+        } catch (const LispError&) {
+            return nullptr;
+        }
+        if (guard.builtin ? !(*value == guard.builtin) : !isSelf(*value, node))
+            return nullptr;
+    }
+    std::optional<Profiler::Frame> frame;
+    if (Profiler::enabled())
+        frame.emplace(node.getName());
+    int64_t result;
+    if (!native->entry(raw, &result)) {
+        if (++native->bails >= MAX_BAILS)
+            native->entry = nullptr;
+        return nullptr;
+    }
+    Stats::count(Stats::APPLY);
+    switch (native->result) {
+    case NativeType::INT: return ValuePtr::integer(result);
+    case NativeType::BOOL: return ValuePtr::boolean(result != 0);
+    default: return ValuePtr::nil();
+    }
+}
+
+NativeCode* LambdaNode::hotCode(EvalEnv& global) const {
+    if (!native) {
+        if (++calls < HOT_CALLS)
+            return nullptr;
+        native = NativeCompiler::compile(*this, global);
+    }
+    return native.get();
+}
+
+// A self call's result has whatever type the body returns, which isn't
+// known until the body has been compiled, so a recursive body is compiled
+// assuming each type in turn until the assumption holds.
+std::shared_ptr<NativeCode> NativeCompiler::compile(const LambdaNode& lambda, EvalEnv& global){
+    if (lambda.getArity() <= MAX_ARITY && lambda.getScope()->names.size() == lambda.getArity()) {
+        for (auto assumed : {NativeType::INT, NativeType::BOOL}) {
+            NativeCompiler c(lambda, global, assumed);
+            try {
+                auto type = c.generate();
+                if (!c.recursive || type == assumed) {
+                    auto native = c.install();
+                    native->result = type;
+                    return native;
+                }
+            } catch (const Unsupported&) {
+                if (!c.recursive)
+                    break;
+            }
+        }
+    }
+    return std::make_shared<NativeCode>();
+}
+
+// The entry stub saves the registers the body relies on and calls it with
+// rdi still pointing at the arguments. A bail-out anywhere in the body
+// restores the stub's stack pointer from r15 and returns 0 from the stub;
+// r14 holds where the result goes and r13 the lowest stack address the
+// body may reach. The body keeps every local, parameters first, in its
+// own frame below rbp, and tail self calls jump back to just after the
+// parameters have been copied in.
+NativeType NativeCompiler::generate(){
+    emit({0x55, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57}); // push rbp, r13, r14, r15
+    emit({0x49, 0x89, 0xE7});                         // mov r15, rsp
+    emit({0x49, 0x89, 0xF6});                         // mov r14, rsi
+    emit({0x4C, 0x8D, 0xAC, 0x24});                   // lea r13, [rsp - limit]
+    emit32(-STACK_LIMIT);
+    emit({0xE8});                                     // call body
+    size_t entryCall = here();
+    emit32(0);
+    emit({0x49, 0x89, 0x06});                         // mov [r14], rax
+    emit({0xB8, 0x01, 0x00, 0x00, 0x00});             // mov eax, 1
+    size_t exit = here();
+    emit({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x5D, 0xC3});
+    bail = here();
+    emit({0x4C, 0x89, 0xFC});                         // mov rsp, r15
+    emit({0x31, 0xC0});                               // xor eax, eax
+    patch(emitJump(), exit);
+
+    body = here();
+    patch(entryCall, body);
+    emit({0x55, 0x48, 0x89, 0xE5});                   // push rbp; mov rbp, rsp
+    emit({0x4C, 0x39, 0xEC});                         // cmp rsp, r13
+    bailIf(BELOW);
+    emit({0x48, 0x81, 0xEC});                         // sub rsp, frame size
+    size_t frameSize = here();
+    emit32(0);
+    frames.emplace_back();
+    for (size_t i = 0; i < lambda.getArity(); i++) {
+        emit({0x48, 0x8B, 0x87});                     // mov rax, [rdi + 8i]
+        emit32(static_cast<int32_t>(8 * i));
+        frames[0].push_back({locals, NativeType::INT});
+        store(locals++);
+    }
+    loop = here();
+    auto type = compile(lambda.getBody(), true);
+    emit({0xC9, 0xC3});                               // leave; ret
+    write32(frameSize, static_cast<int32_t>(8 * locals));
+    return type;
+}
+
+std::shared_ptr<NativeCode> NativeCompiler::install() const {
+    auto native = std::make_shared<NativeCode>();
+#ifdef MINI_LISP_JIT
+    void* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return native;
+    std::memcpy(memory, code.data(), code.size());
+    native->memory = memory;
+    native->size = code.size();
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0)
+        return native;
+    native->entry = reinterpret_cast<NativeCode::Entry>(memory);
+    native->guards = guards;
+#endif
+    return native;
+}
+
+void NativeCompiler::emit32(int32_t value){
+    uint8_t bytes[4];
+    std::memcpy(bytes, &value, 4);
+    code.insert(code.end(), bytes, bytes + 4);
+}
+
+void NativeCompiler::write32(size_t at, int32_t value){
+    std::memcpy(code.data() + at, &value, 4);
+}
+
+void NativeCompiler::patch(size_t at, size_t target){
+    write32(at, static_cast<int32_t>(target) - static_cast<int32_t>(at + 4));
+}
+
+size_t NativeCompiler::emitJump(uint8_t condition){
+    if (condition)
+        emit({0x0F, condition});
+    else
+        emit({0xE9});
+    size_t at = here();
+    emit32(0);
+    return at;
+}
+
+size_t NativeCompiler::emitJumpIf(bool value){
+    emit({0x48, 0x85, 0xC0});                         // test rax, rax
+    return emitJump(value ? NOT_EQUAL : EQUAL);
+}
+
+void NativeCompiler::bailIf(uint8_t condition){
+    patch(emitJump(condition), bail);
+}
+
+void NativeCompiler::emitConstant(int64_t value){
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        emit({0x48, 0xC7, 0xC0});                     // mov rax, imm32
+        emit32(static_cast<int32_t>(value));
+    }
+    else {
+        emit({0x48, 0xB8});                           // mov rax, imm64
+        emit32(static_cast<int32_t>(value));
+        emit32(static_cast<int32_t>(value >> 32));
+    }
+}
+
+void NativeCompiler::load(size_t index){
+    emit({0x48, 0x8B, 0x85});                         // mov rax, [rbp - 8(index + 1)]
+    emit32(-8 * static_cast<int32_t>(index + 1));
+}
+
+void NativeCompiler::store(size_t index){
+    emit({0x48, 0x89, 0x85});                         // mov [rbp - 8(index + 1)], rax
+    emit32(-8 * static_cast<int32_t>(index + 1));
+}
+
+NativeType NativeCompiler::compileAs(const NodePtr& node, bool tail, NativeType type){
+    if (compile(node, tail) != type)
+        throw Unsupported{};
+    return type;
+}
+
+NativeCompiler::Local NativeCompiler::local(size_t depth, size_t slot) const {
+    if (depth >= frames.size() || slot >= frames[frames.size() - 1 - depth].size())
+        throw Unsupported{};
+    return frames[frames.size() - 1 - depth][slot];
+}
+
+void NativeCompiler::enter(const std::vector<NodePtr>& inits){
+    std::vector<Local> frame;
+    for (const auto& init : inits) {
+        frame.push_back({locals, compile(init, false)});
+        store(locals++);
+    }
+    frames.push_back(std::move(frame));
+}
+
+void NativeCompiler::guard(Symbol name, const ValuePtr& builtin){
+    for (const auto& existing : guards)
+        if (existing.name == name)
+            return;
+    guards.push_back({name, builtin, {}});
+}
+
+NativeType NativeCompiler::call(Symbol name, const std::vector<NodePtr>& operands, bool tail){
+    ValuePtr proc;
+    try {
+        proc = global.findGlobal(name);
+    } catch (const LispError&) {
+        throw Unsupported{};
+    }
+    if (isSelf(proc, lambda)) {
+        guard(name, nullptr);
+        return selfCall(operands, tail);
+    }
+    if (proc.getType() == ValueType::BUILTIN_PROC)
+        for (const auto& primitive : PRIMITIVES)
+            if (BUILTIN.at(primitive) == proc) {
+                guard(name, proc);
+                return this->primitive(primitive, operands);
+            }
+    throw Unsupported{};
+}
+
+// Leaves the first of two INT operands in rax and the second in rcx.
+void NativeCompiler::operands(const std::vector<NodePtr>& operands){
+    compileAs(operands[0], false, NativeType::INT);
+    emit({0x50});                                     // push rax
+    compileAs(operands[1], false, NativeType::INT);
+    emit({0x48, 0x89, 0xC1, 0x58});                   // mov rcx, rax; pop rax
+}
+
+NativeType NativeCompiler::primitive(const std::string& name, const std::vector<NodePtr>& args){
+    if (name == "+" || name == "-" || name == "*") {
+        if (args.empty()) {
+            if (name == "-")
+                throw Unsupported{};
+            emitConstant(name == "+" ? 0 : 1);
+            return NativeType::INT;
+        }
+        compileAs(args[0], false, NativeType::INT);
+        if (args.size() == 1 && name == "-") {
+            emit({0x48, 0xF7, 0xD8});                 // neg rax
+            bailIf(OVERFLOW);
+        }
+        for (size_t i = 1; i < args.size(); i++) {
+            emit({0x50});
+            compileAs(args[i], false, NativeType::INT);
+            emit({0x48, 0x89, 0xC1, 0x58});
+            if (name == "+")
+                emit({0x48, 0x01, 0xC8});             // add rax, rcx
+            else if (name == "-")
+                emit({0x48, 0x29, 0xC8});             // sub rax, rcx
+            else
+                emit({0x48, 0x0F, 0xAF, 0xC1});       // imul rax, rcx
+            bailIf(OVERFLOW);
+        }
+        return NativeType::INT;
+    }
+    if (name == "not" || name == "zero?") {
+        if (args.size() != 1)
+            throw Unsupported{};
+        if (name == "zero?") {
+            compileAs(args[0], false, NativeType::INT);
+            emit({0x48, 0x85, 0xC0, 0x0F, 0x94, 0xC0}); // test rax, rax; sete al
+            emit({0x0F, 0xB6, 0xC0});                 // movzx eax, al
+        }
+        else if (compile(args[0], false) == NativeType::BOOL)
+            emit({0x83, 0xF0, 0x01});                 // xor eax, 1
+        else
+            emit({0x31, 0xC0});
+        return NativeType::BOOL;
+    }
+    if (args.size() != 2)
+        throw Unsupported{};
+    operands(args);
+    if (name == "quotient" || name == "remainder") {
+        emit({0x48, 0x85, 0xC9});                     // test rcx, rcx
+        bailIf(EQUAL);
+        emit({0x48, 0x83, 0xF9, 0xFF});               // cmp rcx, -1
+        bailIf(EQUAL);
+        emit({0x48, 0x99, 0x48, 0xF7, 0xF9});         // cqo; idiv rcx
+        if (name == "remainder")
+            emit({0x48, 0x89, 0xD0});                 // mov rax, rdx
+        return NativeType::INT;
+    }
+    uint8_t set = name == "=" ? 0x94 : name == "<" ? 0x9C : name == ">" ? 0x9F
+                : name == "<=" ? 0x9E : 0x9D;
+    emit({0x48, 0x39, 0xC8, 0x0F, set, 0xC0});        // cmp rax, rcx; setcc al
+    emit({0x0F, 0xB6, 0xC0});
+    return NativeType::BOOL;
+}
+
+// The arguments are pushed last first, so they lie in order from rsp.
+NativeType NativeCompiler::selfCall(const std::vector<NodePtr>& args, bool tail){
+    if (args.size() != lambda.getArity())
+        throw Unsupported{};
+    recursive = true;
+    for (size_t i = args.size(); i-- > 0;) {
+        compileAs(args[i], false, NativeType::INT);
+        emit({0x50});
+    }
+    if (tail) {
+        for (size_t i = 0; i < args.size(); i++) {
+            emit({0x58});                             // pop rax
+            store(frames[0][i].index);
+        }
+        patch(emitJump(), loop);
+    }
+    else {
+        emit({0x48, 0x89, 0xE7, 0xE8});               // mov rdi, rsp; call body
+        size_t at = here();
+        emit32(0);
+        patch(at, body);
+        emit({0x48, 0x81, 0xC4});                     // add rsp, 8n
+        emit32(static_cast<int32_t>(8 * args.size()));
+    }
+    return assumed;
+}
+
+NativeType Node::compileNative(NativeCompiler&, bool) const {
+    throw NativeCompiler::Unsupported{};
+}
+
+NativeType ConstantNode::compileNative(NativeCompiler& c, bool) const {
+    if (value.isInt64()) {
+        c.emitConstant(value.asInteger());
+        return NativeType::INT;
+    }
+    if (value.isBoolean() || value.isNil()) {
+        c.emitConstant(value.asBoolean());
+        return value.isNil() ? NativeType::NIL : NativeType::BOOL;
+    }
+    throw NativeCompiler::Unsupported{};
+}
+
+NativeType LocalVariableNode::compileNative(NativeCompiler& c, bool) const {
+    auto local = c.local(depth, slot);
+    c.loadLocal(local);
+    return local.type;
+}
+
+NativeType IfNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (!alternative)
+        throw NativeCompiler::Unsupported{};
+    c.compileAs(test, false, NativeType::BOOL);
+    auto toAlternative = c.emitJumpIf(false);
+    auto type = c.compile(consequent, tail);
+    auto toEnd = c.emitJump();
+    c.patch(toAlternative);
+    c.compileAs(alternative, tail, type);
+    c.patch(toEnd);
+    return type;
+}
+
+NativeType AndNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (operands.empty()) {
+        c.emitConstant(1);
+        return NativeType::BOOL;
+    }
+    std::vector<size_t> exits;
+    for (size_t i = 0; i < operands.size(); i++) {
+        c.compileAs(operands[i], tail && i + 1 == operands.size(), NativeType::BOOL);
+        if (i + 1 < operands.size())
+            exits.push_back(c.emitJumpIf(false));
+    }
+    for (auto exit : exits)
+        c.patch(exit);
+    return NativeType::BOOL;
+}
+
+NativeType OrNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (operands.empty()) {
+        c.emitConstant(0);
+        return NativeType::BOOL;
+    }
+    std::vector<size_t> exits;
+    for (size_t i = 0; i < operands.size(); i++) {
+        c.compileAs(operands[i], tail && i + 1 == operands.size(), NativeType::BOOL);
+        if (i + 1 < operands.size())
+            exits.push_back(c.emitJumpIf(true));
+    }
+    for (auto exit : exits)
+        c.patch(exit);
+    return NativeType::BOOL;
+}
+
+NativeType SequenceNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (body.empty()) {
+        c.emitConstant(0);
+        return NativeType::NIL;
+    }
+    for (size_t i = 0; i + 1 < body.size(); i++)
+        c.compile(body[i], false);
+    return c.compile(body.back(), tail);
+}
+
+NativeType CallNode::compileNative(NativeCompiler& c, bool tail) const {
+    auto global = dynamic_cast<const GlobalVariableNode*>(op.get());
+    if (!global)
+        throw NativeCompiler::Unsupported{};
+    return c.call(global->getName(), operands, tail);
+}
+
+NativeType LetNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (scope->names.size() != inits.size())
+        throw NativeCompiler::Unsupported{};
+    c.enter(inits);
+    auto type = c.compile(body, tail);
+    c.leave();
+    return type;
+}
+
+NativeType DoNode::compileNative(NativeCompiler& c, bool tail) const {
+    if (scope->names.size() != inits.size())
+        throw NativeCompiler::Unsupported{};
+    c.enter(inits);
+    auto start = c.here();
+    c.compileAs(test, false, NativeType::BOOL);
+    auto done = c.emitJumpIf(true);
+    c.compile(body, false);
+    for (size_t i = 0; i < steps.size(); i++)
+        if (steps[i]) {
+            auto local = c.local(0, i);
+            c.compileAs(steps[i], false, local.type);
+            c.storeLocal(local);
+        }
+    c.patch(c.emitJump(), start);
+    c.patch(done);
+    auto type = c.compile(result, tail);
+    c.leave();
+    return type;
+}
@@ -0,0 +1,121 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "./node.h"
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define MINI_LISP_JIT
+#endif
+
+// What a natively compiled expression leaves in rax: a raw int64, 0 or 1
+// for #f or #t, or nothing in particular for ().
+enum class NativeType : uint8_t { INT, BOOL, NIL };
+
+// A global the native code was compiled against, rechecked before every
+// run: it must still name builtin, or when that is null, a procedure whose
+// code is the compiled lambda itself.
+struct NativeGuard {
+    Symbol name;
+    ValuePtr builtin;
+    GlobalCache cache;
+};
+
+// Machine code for one lambda body, in its own executable pages. entry is
+// null when the body could not be compiled or has bailed out too often.
+struct NativeCode {
+    using Entry = int (*)(const int64_t* args, int64_t* result);
+    Entry entry = nullptr;
+    void* memory = nullptr;
+    size_t size = 0;
+    NativeType result = NativeType::NIL;
+    std::vector<NativeGuard> guards;
+    size_t bails = 0;
+    ~NativeCode();
+};
+
+// The optional template JIT. A lambda that has been called often enough is
+// compiled to x86-64 once, if its body only does int64 arithmetic,
+// comparisons, if, and/or, let, do and calls of itself; every argument is
+// then checked to be an exact integer that fits in an int64 before the
+// native code runs. Anything the code can't finish natively, an overflow
+// into bignums or a division by zero, makes it bail out, and the caller
+// runs the whole call in the interpreter instead, which is safe because
+// that code has no side effects.
+class Jit {
+private:
+    static inline bool on = false;
+public:
+    // False, and the JIT stays off, where there is no native backend.
+    static bool enable();
+    static bool enabled() {return on;}
+    // The result of calling lambda on args natively, or null when the
+    // caller must interpret the call.
+    static ValuePtr call(const LambdaValue& lambda, ValueSpan args);
+};
+
+// Emits the native code for one lambda. Nodes compile themselves through
+// compileNative, which throws Unsupported for anything outside the subset.
+class NativeCompiler {
+public:
+    struct Unsupported {};
+    struct Local {
+        size_t index;
+        NativeType type;
+    };
+private:
+    const LambdaNode& lambda;
+    EvalEnv& global;
+    NativeType assumed;
+    std::vector<uint8_t> code;
+    // Innermost last: the lambda's parameters, then each let or do frame.
+    std::vector<std::vector<Local>> frames;
+    std::vector<NativeGuard> guards;
+    size_t locals = 0;
+    size_t bail = 0;
+    size_t body = 0;
+    size_t loop = 0;
+    bool recursive = false;
+
+    NativeCompiler(const LambdaNode& lambda, EvalEnv& global, NativeType assumed)
+        : lambda{lambda}, global{global}, assumed{assumed} {}
+    NativeType generate();
+    std::shared_ptr<NativeCode> install() const;
+    void emit(std::initializer_list<uint8_t> bytes) {code.insert(code.end(), bytes);}
+    void emit32(int32_t value);
+    void write32(size_t at, int32_t value);
+    // A jump, conditional on the opcode byte after 0F when not zero, whose
+    // rel32 target is left to patch.
+    size_t emitJump(uint8_t condition);
+    void bailIf(uint8_t condition);
+    void load(size_t index);
+    void store(size_t index);
+    void guard(Symbol name, const ValuePtr& builtin);
+    void operands(const std::vector<NodePtr>& operands);
+    NativeType primitive(const std::string& name, const std::vector<NodePtr>& operands);
+    NativeType selfCall(const std::vector<NodePtr>& operands, bool tail);
+public:
+    static std::shared_ptr<NativeCode> compile(const LambdaNode& lambda, EvalEnv& global);
+
+    NativeType compile(const NodePtr& node, bool tail) {return node->compileNative(*this, tail);}
+    // As compile, but anything of another type is unsupported.
+    NativeType compileAs(const NodePtr& node, bool tail, NativeType type);
+    void emitConstant(int64_t value);
+    // Jumps with a placeholder target and return where to patch it;
+    // emitJumpIf tests a BOOL.
+    size_t emitJump() {return emitJump(0);}
+    size_t emitJumpIf(bool value);
+    void patch(size_t at) {patch(at, here());}
+    void patch(size_t at, size_t target);
+    size_t here() const {return code.size();}
+
+    Local local(size_t depth, size_t slot) const;
+    void loadLocal(const Local& local) {load(local.index);}
+    void storeLocal(const Local& local) {store(local.index);}
+    // Evaluates inits into fresh locals and opens a frame of them.
+    void enter(const std::vector<NodePtr>& inits);
+    void leave() {frames.pop_back();}
+    NativeType call(Symbol name, const std::vector<NodePtr>& operands, bool tail);
+};
+
+#endif
@@ -5,25 +5,64 @@
 #include "./tokenizer.h"
 #include "./parser.h"
 #include "./eval_env.h"
+#include "./optimizer.h"
+#include "./jit.h"
+#include "./profiler.h"
+#include "./stats.h"
 #include "./error.h"
 
-void runInterpreter(std::string mode, std::istream& input, std::shared_ptr<EvalEnv> env);
+// Set by --dump-optimized: print each form to stderr as it will be
+// evaluated, after constant folding.
+static bool dumpOptimized = false;
+
+void runInterpreter(std::string mode, std::istream& input, EnvPtr env);
 std::istringstream readFromFile(const std::string& filename);
 
 int main(int argc, char* argv[]){
+    std::vector<std::string> args(argv + 1, argv + argc);
+    while (!args.empty() && args[0].starts_with("--")){
+        if (args[0].starts_with("--engine=")){
+            auto engine = args[0].substr(9);
+            if (engine == "vm")
+                EvalEnv::setEngine(Engine::VM);
+            else if (engine != "tree"){
+                std::cerr << "Error: Unknown engine " << engine << std::endl;
+                return 1;
+            }
+        }
+        else if (args[0] == "--dump-optimized")
+            dumpOptimized = true;
+        else if (args[0].starts_with("--profile=")){
+            if (!Profiler::start(args[0].substr(10)))
+                std::cerr << "Warning: --profile is not supported on this platform, ignoring it" << std::endl;
+        }
+        else if (args[0] == "--stats"){
+            if (!Stats::printAtExit())
+                std::cerr << "Warning: this build was configured without MINI_LISP_STATS, ignoring --stats" << std::endl;
+        }
+        else if (args[0] == "--jit"){
+            if (!Jit::enable())
+                std::cerr << "Warning: --jit is not supported on this platform, ignoring it" << std::endl;
+        }
+        else {
+            std::cerr << "Error: Unknown option " << args[0] << std::endl;
+            return 1;
+        }
+        args.erase(args.begin());
+    }
     auto env = EvalEnv::createGlobal();
-    if (argc == 2){
-        std::istringstream file = readFromFile(argv[1]);
+    if (args.size() == 1){
+        std::istringstream file = readFromFile(args[0]);
         runInterpreter("FILE", file, env);
     }
-    else if (argc == 1)
+    else if (args.empty())
         runInterpreter("REPL", std::cin, env);
     else
-        std::cout << "Usage: ./mini_lisp [filename]" << std::endl;
+        std::cout << "Usage: ./mini_lisp [--engine=tree|vm] [--dump-optimized] [--jit] [--profile=out.folded] [--stats] [filename]" << std::endl;
     return 0;
 }
 
-void runInterpreter(std::string mode, std::istream& input, std::shared_ptr<EvalEnv> env){
+void runInterpreter(std::string mode, std::istream& input, EnvPtr env){
     std::string inputBuffer;
     int openBrackets = 0;   
     bool isFirstLine = true;
@@ -50,7 +89,8 @@ void runInterpreter(std::string mode, std::istream& input, std::shared_ptr<EvalE
             
             auto tokens = Tokenizer::tokenize(line);
             for (const auto& token : tokens){
-                if (token->getType() == TokenType::LEFT_PAREN)
+                if (token->getType() == TokenType::LEFT_PAREN || token->getType() == TokenType::F64VECTOR_OPEN
+                    || token->getType() == TokenType::VECTOR_OPEN)
                     openBrackets++;
                 else if (token->getType() == TokenType::RIGHT_PAREN)
                     openBrackets--;
@@ -58,11 +98,18 @@ void runInterpreter(std::string mode, std::istream& input, std::shared_ptr<EvalE
 
             if (openBrackets == 0){
                 auto tokens = Tokenizer::tokenize(inputBuffer);
+                if (tokens.empty()){
+                    inputBuffer = "";
+                    isFirstLine = true;
+                    continue;
+                }
                 Parser parser(std::move(tokens));
-                auto value = parser.parse();
+                auto value = Optimizer::optimize(parser.parse(), *env);
+                if (dumpOptimized)
+                    std::cerr << value.toString() << std::endl;
                 auto result = env->eval(std::move(value));  
                 if (mode == "REPL")
-                    std::cout << result->toString() << std::endl;
+                    std::cout << result.toString() << std::endl;
                 inputBuffer = "";
                 isFirstLine = true;
             }
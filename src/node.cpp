@@ -0,0 +1,231 @@
+#include "./node.h"
+#include "./eval_env.h"
+#include "./builtin.h"
+#include "./error.h"
+#include "./jit.h"
+#include "./equality.h"
+#include <deque>
+
+ValuePtr ConstantNode::eval(EvalEnv&) const {
+    return value;
+}
+
+ValuePtr LocalVariableNode::eval(EvalEnv& env) const {
+    return env.ancestor(depth)->getSlot(slot);
+}
+
+ValuePtr GlobalVariableNode::eval(EvalEnv& env) const {
+    return env.lookupGlobal(name, depth, cache);
+}
+
+ValuePtr GlobalDefineNode::eval(EvalEnv& env) const {
+    env.defineBinding(name, value->eval(env));
+    return ValuePtr::nil();
+}
+
+ValuePtr LocalDefineNode::eval(EvalEnv& env) const {
+    env.setSlot(slot, value->eval(env));
+    return ValuePtr::nil();
+}
+
+ValuePtr TailNode::eval(EvalEnv& env) const {
+    Stats::count(Stats::EVAL);
+    if (Profiler::enabled()) [[unlikely]]
+        return evalProfiled(env);
+    TailCall tail{this, nullptr, nullptr};
+    EvalEnv* frame = &env;
+    while (true) {
+        if (auto result = tail.node->evalTail(*frame, tail))
+            return result;
+        if (tail.env)
+            frame = tail.env.get();
+    }
+}
+
+// The first procedure this loop calls gets a profiler frame of its own,
+// and each tail call after it takes over that frame.
+ValuePtr TailNode::evalProfiled(EvalEnv& env) const {
+    Profiler::Mark mark;
+    TailCall tail{this, nullptr, nullptr};
+    EvalEnv* frame = &env;
+    while (true) {
+        if (auto result = tail.node->evalTail(*frame, tail))
+            return result;
+        if (tail.env)
+            frame = tail.env.get();
+        if (tail.called) {
+            tail.called = false;
+            auto name = static_cast<LambdaValue*>(tail.procedure.get())->getCode()->getName();
+            if (mark.entered())
+                Profiler::replace(name);
+            else
+                Profiler::enter(name);
+        }
+    }
+}
+
+ValuePtr IfNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    if (!test->eval(env).isFalse())
+        tail.node = consequent.get();
+    else if (alternative)
+        tail.node = alternative.get();
+    else
+        return ValuePtr::nil();
+    return nullptr;
+}
+
+ValuePtr AndNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    if (operands.empty())
+        return ValuePtr::boolean(true);
+    for (size_t i = 0; i + 1 < operands.size(); i++) {
+        auto result = operands[i]->eval(env);
+        if (result.isFalse())
+            return result;
+    }
+    tail.node = operands.back().get();
+    return nullptr;
+}
+
+ValuePtr OrNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    if (operands.empty())
+        return ValuePtr::boolean(false);
+    for (size_t i = 0; i + 1 < operands.size(); i++) {
+        auto result = operands[i]->eval(env);
+        if (!result.isFalse())
+            return result;
+    }
+    tail.node = operands.back().get();
+    return nullptr;
+}
+
+ValuePtr SequenceNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    if (body.empty())
+        return ValuePtr::nil();
+    for (size_t i = 0; i + 1 < body.size(); i++)
+        body[i]->eval(env);
+    tail.node = body.back().get();
+    return nullptr;
+}
+
+ValuePtr LambdaNode::eval(EvalEnv& env) const {
+    return makeValue<LambdaValue>(shared_from_this(), EnvPtr(&env));
+}
+
+Symbol LambdaNode::getName() const {
+    static const Symbol anonymous = Symbol::intern("lambda");
+    return name.value_or(anonymous);
+}
+
+namespace {
+
+// Builtins only read their arguments during the call, so each nesting level
+// of builtin calls owns one argument vector that keeps its capacity from
+// call to call. A deque, so handing out a deeper level never moves the
+// vectors of the levels still in use.
+class ArgumentBuffer {
+private:
+    static inline std::deque<std::vector<ValuePtr>> levels;
+    static inline size_t depth = 0;
+    std::vector<ValuePtr>& args;
+    static std::vector<ValuePtr>& acquire() {
+        if (depth == levels.size())
+            levels.emplace_back();
+        return levels[depth++];
+    }
+public:
+    ArgumentBuffer() : args{acquire()} {}
+    ~ArgumentBuffer() {
+        args.clear();
+        depth--;
+    }
+    std::vector<ValuePtr>& operator*() {return args;}
+    std::vector<ValuePtr>* operator->() {return &args;}
+};
+
+}
+
+ValuePtr CallNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    auto proc = op->eval(env);
+    if (proc.getType() == ValueType::BUILTIN_PROC) {
+        auto builtin = static_cast<BuiltinProcValue*>(proc.get());
+        if (operands.size() == 1)
+            return builtin->call(operands[0]->eval(env), env);
+        if (operands.size() == 2) {
+            auto x = operands[0]->eval(env);
+            return builtin->call(x, operands[1]->eval(env), env);
+        }
+        ArgumentBuffer args;
+        for (const auto& operand : operands)
+            args->push_back(operand->eval(env));
+        return builtin->call(*args, env);
+    }
+    Slots args;
+    args.reserve(operands.size());
+    for (const auto& operand : operands)
+        args.push_back(operand->eval(env));
+    if (proc.getType() != ValueType::LAMBDA)
+        return env.apply(proc, args);
+    auto lambda = static_cast<LambdaValue*>(proc.get());
+    if (Jit::enabled())
+        if (auto result = Jit::call(*lambda, args))
+            return result;
+    auto frame = lambda->bind(std::move(args));
+    tail.node = lambda->getBody();
+    tail.procedure = std::move(proc);
+    tail.env = std::move(frame);
+    tail.called = true;
+    return nullptr;
+}
+
+ValuePtr LetNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    Slots vals;
+    vals.reserve(inits.size());
+    for (const auto& init : inits)
+        vals.push_back(init->eval(env));
+    tail.node = body.get();
+    tail.env = env.createChild(scope, std::move(vals));
+    return nullptr;
+}
+
+ValuePtr CaseNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    auto value = key->eval(env);
+    for (const auto& clause : clauses) {
+        for (const auto& datum : clause.data) {
+            if (Equality::equal(value, datum)) {
+                tail.node = clause.body.get();
+                return nullptr;
+            }
+        }
+    }
+    if (!elseBody)
+        return ValuePtr::nil();
+    tail.node = elseBody.get();
+    return nullptr;
+}
+
+ValuePtr ConsNode::eval(EvalEnv& env) const {
+    auto first = car->eval(env);
+    return makeValue<PairValue>(std::move(first), cdr->eval(env));
+}
+
+ValuePtr DelayNode::eval(EvalEnv& env) const {
+    return makeValue<PromiseValue>(thunk->eval(env));
+}
+
+ValuePtr DoNode::evalTail(EvalEnv& env, TailCall& tail) const {
+    Slots vals;
+    vals.reserve(inits.size());
+    for (const auto& init : inits)
+        vals.push_back(init->eval(env));
+    auto child = env.createChild(scope, std::move(vals));
+    // Steps run in order and each sees the ones already updated, so
+    // (sum 0 (+ sum i)) after (i 0 (+ i 1)) accumulates the new i.
+    while (test->eval(*child).isFalse()) {
+        body->eval(*child);
+        for (size_t i = 0; i < steps.size(); i++)
+            if (steps[i]) child->setSlot(i, steps[i]->eval(*child));
+    }
+    tail.node = result.get();
+    tail.env = std::move(child);
+    return nullptr;
+}
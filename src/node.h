@@ -0,0 +1,281 @@
+#ifndef NODE_H
+#define NODE_H
+
+#include "./value.h"
+#include "./eval_env.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Compiler;
+class NativeCompiler;
+struct Scope;
+struct Chunk;
+struct NativeCode;
+enum class NativeType : uint8_t;
+
+// A Node is an s-expression that has already been analyzed: special forms
+// are recognized, operands are split out and symbols are extracted once, so
+// evaluating the same code again never re-walks the PairValue tree.
+class Node;
+using NodePtr = std::shared_ptr<const Node>;
+
+// Where evaluation continues after a node hands over its tail position: the
+// node to run next, the frame to run it in when that changes, and the
+// procedure whose body it is, which keeps that code alive.
+// called is set whenever procedure is a newly called one.
+struct TailCall {
+    const Node* node;
+    EnvPtr env;
+    ValuePtr procedure;
+    bool called = false;
+};
+
+class Node {
+public:
+    virtual ~Node() = default;
+    virtual ValuePtr eval(EvalEnv& env) const = 0;
+    // Either returns the value, or returns nullptr after filling tail with
+    // what to evaluate instead; nodes without a tail position just eval.
+    virtual ValuePtr evalTail(EvalEnv& env, TailCall& tail) const {
+        return eval(env);
+    }
+    // Emits bytecode leaving the node's value on the stack; compileTail
+    // emits code that instead returns it from the enclosing procedure.
+    virtual void compile(Compiler& c) const = 0;
+    virtual void compileTail(Compiler& c) const;
+    // Emits x86-64 code leaving the node's value in rax, for the JIT; tail
+    // is whether that value is the enclosing procedure's result. Nodes that
+    // don't override it are never compiled natively.
+    virtual NativeType compileNative(NativeCompiler& c, bool tail) const;
+};
+
+// A node with a subexpression in tail position. eval drives evalTail in a
+// loop, so a chain of tail calls runs in constant C++ stack and each new
+// frame replaces the one before it.
+class TailNode : public Node {
+private:
+    // eval, keeping the profiler's stack in step with the calls made.
+    ValuePtr evalProfiled(EvalEnv& env) const;
+public:
+    ValuePtr eval(EvalEnv& env) const override;
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override = 0;
+    void compile(Compiler& c) const override {generate(c, false);}
+    void compileTail(Compiler& c) const override {generate(c, true);}
+protected:
+    virtual void generate(Compiler& c, bool tail) const = 0;
+};
+
+class ConstantNode : public Node {
+private:
+    ValuePtr value;
+public:
+    ConstantNode(ValuePtr value) : value{std::move(value)} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+// A variable bound in an enclosing local frame: depth frames up, at slot.
+class LocalVariableNode : public Node {
+private:
+    Symbol name;
+    size_t depth;
+    size_t slot;
+public:
+    LocalVariableNode(Symbol name, size_t depth, size_t slot) : name{name}, depth{depth}, slot{slot} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+// A variable not bound by any enclosing scope; depth is the number of local
+// frames between the reference and the global frame.
+class GlobalVariableNode : public Node {
+private:
+    Symbol name;
+    size_t depth;
+    mutable GlobalCache cache;
+public:
+    GlobalVariableNode(Symbol name, size_t depth) : name{name}, depth{depth} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+    Symbol getName() const {return name;}
+    size_t getDepth() const {return depth;}
+};
+
+class GlobalDefineNode : public Node {
+private:
+    Symbol name;
+    NodePtr value;
+public:
+    GlobalDefineNode(Symbol name, NodePtr value) : name{name}, value{std::move(value)} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+};
+
+class LocalDefineNode : public Node {
+private:
+    size_t slot;
+    NodePtr value;
+public:
+    LocalDefineNode(size_t slot, NodePtr value) : slot{slot}, value{std::move(value)} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+};
+
+class IfNode : public TailNode {
+private:
+    NodePtr test;
+    NodePtr consequent;
+    NodePtr alternative;
+public:
+    IfNode(NodePtr test, NodePtr consequent, NodePtr alternative)
+        : test{std::move(test)}, consequent{std::move(consequent)}, alternative{std::move(alternative)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+class AndNode : public TailNode {
+private:
+    std::vector<NodePtr> operands;
+public:
+    AndNode(std::vector<NodePtr> operands) : operands{std::move(operands)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+class OrNode : public TailNode {
+private:
+    std::vector<NodePtr> operands;
+public:
+    OrNode(std::vector<NodePtr> operands) : operands{std::move(operands)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+class SequenceNode : public TailNode {
+private:
+    std::vector<NodePtr> body;
+public:
+    SequenceNode(std::vector<NodePtr> body) : body{std::move(body)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+// The first arity slots of the scope are the parameters; the rest are the
+// body's internal defines.
+class LambdaNode : public Node, public std::enable_shared_from_this<LambdaNode> {
+private:
+    std::shared_ptr<Scope> scope;
+    size_t arity;
+    NodePtr body;
+    std::optional<Symbol> name;
+    // Bytecode for the body, compiled the first time the VM calls it.
+    mutable std::shared_ptr<const Chunk> chunk;
+    // Native code for the body once the JIT has tried to compile it, and
+    // the calls counted until then.
+    mutable std::shared_ptr<NativeCode> native;
+    mutable uint32_t calls = 0;
+public:
+    LambdaNode(std::shared_ptr<Scope> scope, size_t arity, NodePtr body, std::optional<Symbol> name = std::nullopt)
+        : scope{std::move(scope)}, arity{arity}, body{std::move(body)}, name{name} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+    const std::shared_ptr<Scope>& getScope() const {return scope;}
+    size_t getArity() const {return arity;}
+    const NodePtr& getBody() const {return body;}
+    bool isNamed() const {return name.has_value();}
+    // The name define gave it, or lambda.
+    Symbol getName() const;
+    const Chunk& compiled() const;
+    // Null until the body is hot enough to compile natively.
+    NativeCode* hotCode(EvalEnv& global) const;
+};
+
+class CallNode : public TailNode {
+private:
+    NodePtr op;
+    std::vector<NodePtr> operands;
+public:
+    CallNode(NodePtr op, std::vector<NodePtr> operands) : op{std::move(op)}, operands{std::move(operands)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+class LetNode : public TailNode {
+private:
+    std::shared_ptr<Scope> scope;
+    std::vector<NodePtr> inits;
+    NodePtr body;
+public:
+    LetNode(std::shared_ptr<Scope> scope, std::vector<NodePtr> inits, NodePtr body)
+        : scope{std::move(scope)}, inits{std::move(inits)}, body{std::move(body)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+class CaseNode : public TailNode {
+public:
+    struct Clause {
+        std::vector<ValuePtr> data;
+        NodePtr body;
+    };
+private:
+    NodePtr key;
+    std::vector<Clause> clauses;
+    NodePtr elseBody;
+public:
+    CaseNode(NodePtr key, std::vector<Clause> clauses, NodePtr elseBody)
+        : key{std::move(key)}, clauses{std::move(clauses)}, elseBody{std::move(elseBody)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+};
+
+// Builds a fresh pair from two evaluated halves; quasiquote templates are
+// analyzed into a tree of these around their unquoted parts.
+class ConsNode : public Node {
+private:
+    NodePtr car;
+    NodePtr cdr;
+public:
+    ConsNode(NodePtr car, NodePtr cdr) : car{std::move(car)}, cdr{std::move(cdr)} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+};
+
+class DelayNode : public Node {
+private:
+    std::shared_ptr<const LambdaNode> thunk;
+public:
+    DelayNode(std::shared_ptr<const LambdaNode> thunk) : thunk{std::move(thunk)} {}
+    ValuePtr eval(EvalEnv& env) const override;
+    void compile(Compiler& c) const override;
+};
+
+class DoNode : public TailNode {
+private:
+    std::shared_ptr<Scope> scope;
+    std::vector<NodePtr> inits;
+    std::vector<NodePtr> steps;
+    NodePtr test;
+    NodePtr result;
+    NodePtr body;
+public:
+    DoNode(std::shared_ptr<Scope> scope, std::vector<NodePtr> inits, std::vector<NodePtr> steps,
+           NodePtr test, NodePtr result, NodePtr body)
+        : scope{std::move(scope)}, inits{std::move(inits)}, steps{std::move(steps)},
+          test{std::move(test)}, result{std::move(result)}, body{std::move(body)} {}
+    ValuePtr evalTail(EvalEnv& env, TailCall& tail) const override;
+    void generate(Compiler& c, bool tail) const override;
+    NativeType compileNative(NativeCompiler& c, bool tail) const override;
+};
+
+#endif
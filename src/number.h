@@ -0,0 +1,52 @@
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <cstdint>
+#include <limits>
+
+// Overflow-checked int64 arithmetic for exact integers. Each returns false,
+// leaving result unspecified, when the exact answer does not fit.
+#if defined(__GNUC__) || defined(__clang__)
+
+inline bool checkedAdd(int64_t a, int64_t b, int64_t& result) {
+    return !__builtin_add_overflow(a, b, &result);
+}
+
+inline bool checkedSub(int64_t a, int64_t b, int64_t& result) {
+    return !__builtin_sub_overflow(a, b, &result);
+}
+
+inline bool checkedMul(int64_t a, int64_t b, int64_t& result) {
+    return !__builtin_mul_overflow(a, b, &result);
+}
+
+#else
+
+inline constexpr int64_t INT64_LIMIT_MAX = std::numeric_limits<int64_t>::max();
+inline constexpr int64_t INT64_LIMIT_MIN = std::numeric_limits<int64_t>::min();
+
+inline bool checkedAdd(int64_t a, int64_t b, int64_t& result) {
+    if (b > 0 ? a > INT64_LIMIT_MAX - b : a < INT64_LIMIT_MIN - b)
+        return false;
+    result = a + b;
+    return true;
+}
+
+inline bool checkedSub(int64_t a, int64_t b, int64_t& result) {
+    if (b < 0 ? a > INT64_LIMIT_MAX + b : a < INT64_LIMIT_MIN + b)
+        return false;
+    result = a - b;
+    return true;
+}
+
+inline bool checkedMul(int64_t a, int64_t b, int64_t& result) {
+    if (a > 0 ? (b > 0 ? a > INT64_LIMIT_MAX / b : b < INT64_LIMIT_MIN / a)
+              : (b > 0 ? a < INT64_LIMIT_MIN / b : a != 0 && b < INT64_LIMIT_MAX / a))
+        return false;
+    result = a * b;
+    return true;
+}
+
+#endif
+
+#endif
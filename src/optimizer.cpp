@@ -0,0 +1,374 @@
+#include "./optimizer.h"
+#include "./eval_env.h"
+#include "./builtin.h"
+#include <optional>
+
+static const Symbol QUOTE = Symbol::intern("quote");
+static const Symbol QUASIQUOTE = Symbol::intern("quasiquote");
+static const Symbol UNQUOTE = Symbol::intern("unquote");
+static const Symbol DEFINE = Symbol::intern("define");
+static const Symbol LAMBDA = Symbol::intern("lambda");
+static const Symbol DELAY = Symbol::intern("delay");
+static const Symbol IF = Symbol::intern("if");
+static const Symbol COND = Symbol::intern("cond");
+static const Symbol CASE = Symbol::intern("case");
+static const Symbol LET = Symbol::intern("let");
+static const Symbol LET_STAR = Symbol::intern("let*");
+static const Symbol DO = Symbol::intern("do");
+static const Symbol BEGIN = Symbol::intern("begin");
+static const Symbol AND = Symbol::intern("and");
+static const Symbol OR = Symbol::intern("or");
+static const Symbol ELSE = Symbol::intern("else");
+
+// Builtins whose result depends on nothing but their arguments.
+static const std::unordered_set<std::string> FOLDABLE{
+    "+", "-", "*", "/", "abs", "quotient", "remainder", "modulo", "expt",
+    "=", "<", ">", "<=", ">=", "not", "zero?", "odd?", "even?",
+};
+
+static bool isLiteral(const ValuePtr& value){
+    return value.isNumber() || value.isBoolean();
+}
+
+// The elements of expr when it is a proper list.
+static std::optional<std::vector<ValuePtr>> elements(const ValuePtr& expr){
+    ValuePtr current = expr;
+    while (current.getType() == ValueType::PAIR)
+        current = static_cast<PairValue*>(current.get())->getCdr();
+    if (!current.isNil())
+        return std::nullopt;
+    return expr.toVector();
+}
+
+static ValuePtr list(const std::vector<ValuePtr>& values){
+    ValuePtr result = ValuePtr::nil();
+    for (size_t i = values.size(); i-- > 0;)
+        result = makeValue<PairValue>(values[i], std::move(result));
+    return result;
+}
+
+// The head of form followed by its rewritten rest.
+static ValuePtr rebuild(const std::vector<ValuePtr>& form, size_t keep, std::vector<ValuePtr> rest){
+    rest.insert(rest.begin(), form.begin(), form.begin() + keep);
+    return list(rest);
+}
+
+static bool isKeyword(const ValuePtr& value, Symbol keyword){
+    auto symbol = value.asSymbol();
+    return symbol && *symbol == keyword;
+}
+
+// Calls f on every symbol in a parameter list, which may be dotted or a
+// single symbol.
+template <typename F>
+static void forEachName(const ValuePtr& names, F f){
+    ValuePtr current = names;
+    while (current.getType() == ValueType::PAIR) {
+        auto pair = static_cast<PairValue*>(current.get());
+        if (auto name = pair->getCar().asSymbol())
+            f(*name);
+        current = pair->getCdr();
+    }
+    if (auto name = current.asSymbol())
+        f(*name);
+}
+
+// Calls f on the name each binding of a let or do binds.
+template <typename F>
+static void forEachBound(const ValuePtr& specs, F f){
+    ValuePtr current = specs;
+    while (current.getType() == ValueType::PAIR) {
+        auto pair = static_cast<PairValue*>(current.get());
+        if (pair->getCar().getType() == ValueType::PAIR) {
+            if (auto name = static_cast<PairValue*>(pair->getCar().get())->getCar().asSymbol())
+                f(*name);
+        }
+        current = pair->getCdr();
+    }
+}
+
+// The names a body defines internally, as Analyzer::analyzeBody declares
+// them.
+template <typename F>
+static void forEachDefinition(const std::vector<ValuePtr>& body, size_t begin, F f){
+    for (size_t i = begin; i < body.size(); i++) {
+        auto form = elements(body[i]);
+        if (!form || form->size() < 2)
+            continue;
+        if (isKeyword((*form)[0], BEGIN))
+            forEachDefinition(*form, 1, f);
+        else if (!isKeyword((*form)[0], DEFINE))
+            continue;
+        else if (auto name = (*form)[1].asSymbol())
+            f(*name);
+        else if ((*form)[1].getType() == ValueType::PAIR) {
+            if (auto name = static_cast<PairValue*>((*form)[1].get())->getCar().asSymbol())
+                f(*name);
+        }
+    }
+}
+
+ValuePtr Optimizer::optimize(const ValuePtr& expr, EvalEnv& env){
+    Optimizer optimizer(env);
+    optimizer.collectBindings(expr);
+    return optimizer.walk(expr);
+}
+
+// Every name the form binds anywhere, whatever the scope: none of them is
+// trusted to still be a builtin.
+void Optimizer::collectBindings(const ValuePtr& expr){
+    auto form = elements(expr);
+    if (!form || form->empty() || isKeyword((*form)[0], QUOTE))
+        return;
+    auto insert = [this](Symbol name){rebound.insert(name);};
+    if (form->size() > 1) {
+        if (isKeyword((*form)[0], DEFINE) || isKeyword((*form)[0], LAMBDA))
+            forEachName((*form)[1], insert);
+        else if (isKeyword((*form)[0], LET) || isKeyword((*form)[0], LET_STAR) || isKeyword((*form)[0], DO))
+            forEachBound((*form)[1], insert);
+    }
+    for (const auto& element : *form)
+        collectBindings(element);
+}
+
+ValuePtr Optimizer::lookup(Symbol name) const {
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it)
+        if (it->first == name)
+            return it->second;
+    return nullptr;
+}
+
+void Optimizer::hide(const ValuePtr& names){
+    forEachName(names, [this](Symbol name){bindings.emplace_back(name, nullptr);});
+}
+
+void Optimizer::hideDefinitions(const std::vector<ValuePtr>& body, size_t begin){
+    forEachDefinition(body, begin, [this](Symbol name){bindings.emplace_back(name, nullptr);});
+}
+
+std::vector<ValuePtr> Optimizer::walkAll(const std::vector<ValuePtr>& exprs, size_t begin){
+    std::vector<ValuePtr> result;
+    for (size_t i = begin; i < exprs.size(); i++)
+        result.push_back(walk(exprs[i]));
+    return result;
+}
+
+// An expression that may or may not run once its form is evaluated: folding
+// a call in it could do work the program never asks for.
+ValuePtr Optimizer::walkConditional(const ValuePtr& expr){
+    bool outer = immediate;
+    immediate = false;
+    auto result = walk(expr);
+    immediate = outer;
+    return result;
+}
+
+std::vector<ValuePtr> Optimizer::walkAllConditional(const std::vector<ValuePtr>& exprs, size_t begin){
+    std::vector<ValuePtr> result;
+    for (size_t i = begin; i < exprs.size(); i++)
+        result.push_back(walkConditional(exprs[i]));
+    return result;
+}
+
+// A body whose own bindings were pushed since mark. A conditional body may
+// run later, or never, so calls in it are never folded.
+std::vector<ValuePtr> Optimizer::walkBody(const std::vector<ValuePtr>& form, size_t begin, size_t mark, bool conditional){
+    hideDefinitions(form, begin);
+    bool outer = immediate;
+    immediate = immediate && !conditional;
+    auto result = walkAll(form, begin);
+    immediate = outer;
+    bindings.erase(bindings.begin() + mark, bindings.end());
+    return result;
+}
+
+ValuePtr Optimizer::walk(const ValuePtr& expr){
+    if (auto name = expr.asSymbol()) {
+        if (auto value = lookup(*name))
+            return value;
+        return expr;
+    }
+    auto form = elements(expr);
+    if (!form || form->empty())
+        return expr;
+    auto op = (*form)[0].asSymbol();
+    if (!op)
+        return walkCall(walkAll(*form, 0));
+    size_t mark = bindings.size();
+    if (*op == QUOTE)
+        return expr;
+    if (*op == QUASIQUOTE && form->size() == 2)
+        return rebuild(*form, 1, {walkTemplate((*form)[1])});
+    if (*op == LAMBDA && form->size() > 2) {
+        hide((*form)[1]);
+        return rebuild(*form, 2, walkBody(*form, 2, mark, true));
+    }
+    if (*op == DEFINE && form->size() > 2 && (*form)[1].getType() == ValueType::PAIR) {
+        hide(static_cast<PairValue*>((*form)[1].get())->getCdr());
+        return rebuild(*form, 2, walkBody(*form, 2, mark, true));
+    }
+    if (*op == DEFINE && form->size() == 3)
+        return rebuild(*form, 2, {walk((*form)[2])});
+    if (*op == DELAY && form->size() == 2)
+        return rebuild(*form, 1, walkBody(*form, 1, mark, true));
+    if (*op == IF && (form->size() == 3 || form->size() == 4)) {
+        auto test = walk((*form)[1]);
+        if (!isLiteral(test)) {
+            auto rest = walkAllConditional(*form, 2);
+            rest.insert(rest.begin(), test);
+            return rebuild(*form, 1, std::move(rest));
+        }
+        if (!test.isFalse())
+            return walk((*form)[2]);
+        if (form->size() == 4)
+            return walk((*form)[3]);
+        return list({makeValue<SymbolValue>(QUOTE), ValuePtr::nil()});
+    }
+    if (*op == LET || *op == LET_STAR)
+        return walkLet(*form, *op == LET_STAR);
+    if (*op == DO)
+        return walkDo(*form);
+    // Only the first test of a cond, the key of a case and the first operand
+    // of and/or always run.
+    if (*op == COND) {
+        std::vector<ValuePtr> clauses;
+        for (size_t i = 1; i < form->size(); i++) {
+            auto clause = elements((*form)[i]);
+            if (!clause || clause->empty())
+                clauses.push_back((*form)[i]);
+            else if (isKeyword((*clause)[0], ELSE))
+                clauses.push_back(rebuild(*clause, 1, walkAllConditional(*clause, 1)));
+            else {
+                auto rest = walkAllConditional(*clause, 1);
+                rest.insert(rest.begin(), i == 1 ? walk((*clause)[0]) : walkConditional((*clause)[0]));
+                clauses.push_back(list(rest));
+            }
+        }
+        return rebuild(*form, 1, std::move(clauses));
+    }
+    if (*op == CASE && form->size() > 1) {
+        std::vector<ValuePtr> rest{walk((*form)[1])};
+        for (size_t i = 2; i < form->size(); i++) {
+            auto clause = elements((*form)[i]);
+            if (!clause || clause->empty())
+                rest.push_back((*form)[i]);
+            else
+                rest.push_back(rebuild(*clause, 1, walkAllConditional(*clause, 1)));
+        }
+        return rebuild(*form, 1, std::move(rest));
+    }
+    if ((*op == AND || *op == OR) && form->size() > 1) {
+        auto rest = walkAllConditional(*form, 2);
+        rest.insert(rest.begin(), walk((*form)[1]));
+        return rebuild(*form, 1, std::move(rest));
+    }
+    return walkCall(walkAll(*form, 0));
+}
+
+// The unquoted parts of a quasiquote template, found the way the analyzer's
+// quasiquote finds them, are walked; the rest is data.
+ValuePtr Optimizer::walkTemplate(const ValuePtr& expr){
+    if (expr.getType() != ValueType::PAIR)
+        return expr;
+    auto pair = static_cast<PairValue*>(expr.get());
+    if (isKeyword(pair->getCar(), UNQUOTE)) {
+        auto form = elements(expr);
+        if (!form || form->size() != 2)
+            return expr;
+        return rebuild(*form, 1, {walk((*form)[1])});
+    }
+    auto car = walkTemplate(pair->getCar());
+    auto cdr = walkTemplate(pair->getCdr());
+    if (car == pair->getCar() && cdr == pair->getCdr())
+        return expr;
+    return makeValue<PairValue>(std::move(car), std::move(cdr));
+}
+
+// Bindings whose initializer reduces to a literal, and which the body does
+// not define again, are substituted into the body. The bindings themselves
+// stay: eval and quoted code can still name them at run time.
+ValuePtr Optimizer::walkLet(const std::vector<ValuePtr>& form, bool sequential){
+    auto specs = form.size() > 2 ? elements(form[1]) : std::nullopt;
+    if (!specs)
+        return list(form);
+    for (const auto& spec : *specs) {
+        auto parts = elements(spec);
+        if (!parts || parts->size() != 2 || !(*parts)[0].asSymbol())
+            return list(form);
+    }
+    std::unordered_set<Symbol> defined;
+    forEachDefinition(form, 2, [&defined](Symbol name){defined.insert(name);});
+    size_t mark = bindings.size();
+    std::vector<std::pair<Symbol, ValuePtr>> pending;
+    std::vector<ValuePtr> newSpecs;
+    for (const auto& spec : *specs) {
+        auto parts = spec.toVector();
+        auto name = *parts[0].asSymbol();
+        auto init = walk(parts[1]);
+        ValuePtr constant = nullptr;
+        if (isLiteral(init) && !defined.count(name))
+            constant = init;
+        newSpecs.push_back(list({parts[0], init}));
+        if (sequential)
+            bindings.emplace_back(name, constant);
+        else
+            pending.emplace_back(name, constant);
+    }
+    bindings.insert(bindings.end(), pending.begin(), pending.end());
+    auto body = walkBody(form, 2, mark, false);
+    body.insert(body.begin(), list(newSpecs));
+    return rebuild(form, 1, std::move(body));
+}
+
+ValuePtr Optimizer::walkDo(const std::vector<ValuePtr>& form){
+    auto specs = form.size() > 2 ? elements(form[1]) : std::nullopt;
+    auto test = form.size() > 2 ? elements(form[2]) : std::nullopt;
+    if (!specs || !test || test->empty())
+        return list(form);
+    std::vector<std::vector<ValuePtr>> parts;
+    for (const auto& spec : *specs) {
+        auto part = elements(spec);
+        if (!part || (part->size() != 2 && part->size() != 3) || !(*part)[0].asSymbol())
+            return list(form);
+        parts.push_back(std::move(*part));
+    }
+    for (auto& part : parts)
+        part[1] = walk(part[1]);
+    size_t mark = bindings.size();
+    for (const auto& part : parts)
+        bindings.emplace_back(*part[0].asSymbol(), nullptr);
+    hideDefinitions(form, 3);
+    std::vector<ValuePtr> newSpecs;
+    // The first test always runs; steps, body and results may not.
+    for (auto& part : parts) {
+        if (part.size() == 3)
+            part[2] = walkConditional(part[2]);
+        newSpecs.push_back(list(part));
+    }
+    auto tests = walkAllConditional(*test, 1);
+    tests.insert(tests.begin(), walk((*test)[0]));
+    std::vector<ValuePtr> rest{list(newSpecs), list(tests)};
+    auto body = walkBody(form, 3, mark, true);
+    rest.insert(rest.end(), body.begin(), body.end());
+    return rebuild(form, 1, std::move(rest));
+}
+
+ValuePtr Optimizer::walkCall(std::vector<ValuePtr> form){
+    auto name = form[0].asSymbol();
+    if (!immediate || !name || rebound.count(*name) || !FOLDABLE.count(name->str()))
+        return list(form);
+    for (size_t i = 1; i < form.size(); i++)
+        if (!isLiteral(form[i]))
+            return list(form);
+    auto builtin = BUILTIN.find(name->str());
+    if (builtin == BUILTIN.end() || !(env.lookupBinding(*name) == builtin->second))
+        return list(form);
+    try {
+        auto proc = static_cast<BuiltinProcValue*>(builtin->second.get());
+        auto result = proc->call(ValueSpan(form.data() + 1, form.size() - 1), env);
+        if (isLiteral(result))
+            return result;
+    }
+    catch (std::runtime_error&) {}
+    return list(form);
+}
@@ -0,0 +1,55 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "./value.h"
+#include <unordered_set>
+
+class EvalEnv;
+
+// Rewrites a parsed top-level form into a simpler one with the same
+// meaning before it is analyzed:
+//   - let and let* bindings to number or boolean literals are substituted
+//     into their bodies, including unquoted parts of quasiquotes; the
+//     bindings are kept for eval and other run-time lookups;
+//   - an if whose test is a literal becomes the branch it selects;
+//   - calls of arithmetic and comparison builtins on literal operands are
+//     replaced by their results.
+// Folding a call relies on the builtin's binding and does the call's work
+// up front, so it only happens in code certain to run while the form is
+// being evaluated. Calls inside lambda, procedure define and delay bodies
+// are never folded: the body may run after a later define has replaced the
+// builtin. Neither are calls in code that may be skipped: the branches of
+// an if whose test is not a literal, cond clauses past the first test, case
+// clauses, and/or operands past the first, and the steps, body and results
+// of a do. Folding is also limited
+// to names that are still bound to the builtin in the global frame and
+// that the form itself never binds. Calls that would raise an error are
+// left in place to raise it at run time.
+class Optimizer {
+private:
+    EvalEnv& env;
+    std::unordered_set<Symbol> rebound;
+    // Innermost last: a let-bound constant, or a null value for a local
+    // binding that hides any constant of the same name further out.
+    std::vector<std::pair<Symbol, ValuePtr>> bindings;
+    bool immediate = true;
+
+    Optimizer(EvalEnv& env) : env{env} {}
+    void collectBindings(const ValuePtr& expr);
+    ValuePtr lookup(Symbol name) const;
+    void hide(const ValuePtr& names);
+    void hideDefinitions(const std::vector<ValuePtr>& body, size_t begin);
+    ValuePtr walk(const ValuePtr& expr);
+    ValuePtr walkTemplate(const ValuePtr& expr);
+    std::vector<ValuePtr> walkAll(const std::vector<ValuePtr>& exprs, size_t begin);
+    ValuePtr walkConditional(const ValuePtr& expr);
+    std::vector<ValuePtr> walkAllConditional(const std::vector<ValuePtr>& exprs, size_t begin);
+    std::vector<ValuePtr> walkBody(const std::vector<ValuePtr>& form, size_t begin, size_t mark, bool conditional);
+    ValuePtr walkLet(const std::vector<ValuePtr>& form, bool sequential);
+    ValuePtr walkDo(const std::vector<ValuePtr>& form);
+    ValuePtr walkCall(std::vector<ValuePtr> form);
+public:
+    static ValuePtr optimize(const ValuePtr& expr, EvalEnv& env);
+};
+
+#endif
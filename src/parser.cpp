@@ -13,52 +13,53 @@ ValuePtr Parser::parse(){
     }
     auto token = tokens.front().get();
     if(token->getType() == TokenType::NUMERIC_LITERAL){
-        auto value = static_cast<NumericLiteralToken&>(*token).getValue();
+        auto& literal = static_cast<NumericLiteralToken&>(*token);
+        auto value = literal.getInteger() ? ValuePtr::integer(*BigInt::parse(*literal.getInteger())) : ValuePtr::number(literal.getValue());
         tokens.pop_front();
-        return std::make_shared<NumericValue>(value);
+        return value;
     }
     if(token->getType() == TokenType::BOOLEAN_LITERAL){
         auto value = static_cast<BooleanLiteralToken&>(*token).getValue();
         tokens.pop_front();
-        return std::make_shared<BooleanValue>(value);
+        return ValuePtr::boolean(value);
     }
     if(token->getType() == TokenType::STRING_LITERAL){
         auto value = static_cast<StringLiteralToken&>(*token).getValue();
         tokens.pop_front();
-        return std::make_shared<StringValue>(value);
+        return makeValue<StringValue>(value);
     }
     if(token->getType() == TokenType::IDENTIFIER){
         auto value = static_cast<IdentifierToken&>(*token).getName();
         tokens.pop_front();
-        return std::make_shared<SymbolValue>(value);
+        return makeValue<SymbolValue>(Symbol::intern(value));
     }
     if (token->getType() == TokenType::QUOTE) {
     tokens.pop_front();
-    return std::make_shared<PairValue>(
-      std::make_shared<SymbolValue>("quote"),
-      std::make_shared<PairValue>(
+    return makeValue<PairValue>(
+      makeValue<SymbolValue>(Symbol::intern("quote")),
+      makeValue<PairValue>(
           this->parse(),
-          std::make_shared<NilValue>()
+          ValuePtr::nil()
       )
     );
     }
     if (token->getType() == TokenType::QUASIQUOTE) {
     tokens.pop_front();
-    return std::make_shared<PairValue>(
-      std::make_shared<SymbolValue>("quasiquote"),
-      std::make_shared<PairValue>(
+    return makeValue<PairValue>(
+      makeValue<SymbolValue>(Symbol::intern("quasiquote")),
+      makeValue<PairValue>(
           this->parse(),
-          std::make_shared<NilValue>()
+          ValuePtr::nil()
       )
     );
     }
     if (token->getType() == TokenType::UNQUOTE) {
     tokens.pop_front();
-    return std::make_shared<PairValue>(
-      std::make_shared<SymbolValue>("unquote"),
-      std::make_shared<PairValue>(
+    return makeValue<PairValue>(
+      makeValue<SymbolValue>(Symbol::intern("unquote")),
+      makeValue<PairValue>(
           this->parse(),
-          std::make_shared<NilValue>()
+          ValuePtr::nil()
       )
     );
     }
@@ -66,6 +67,30 @@ ValuePtr Parser::parse(){
         tokens.pop_front();
         return this->parseTails();
     }
+    if (token->getType() == TokenType::F64VECTOR_OPEN){
+        tokens.pop_front();
+        std::vector<double> elements;
+        while (!tokens.empty() && tokens.front()->getType() != TokenType::RIGHT_PAREN) {
+            auto element = this->parse();
+            if (!element.isNumber())
+                throw SyntaxError("Expected a number in #f64 literal");
+            elements.push_back(element.asNumber());
+        }
+        if (tokens.empty())
+            throw SyntaxError("Unexpected end of input");
+        tokens.pop_front();
+        return makeValue<F64VectorValue>(std::move(elements));
+    }
+    if (token->getType() == TokenType::VECTOR_OPEN){
+        tokens.pop_front();
+        std::vector<ValuePtr> elements;
+        while (!tokens.empty() && tokens.front()->getType() != TokenType::RIGHT_PAREN)
+            elements.push_back(this->parse());
+        if (tokens.empty())
+            throw SyntaxError("Unexpected end of input");
+        tokens.pop_front();
+        return makeValue<VectorValue>(std::move(elements));
+    }
     else{
         throw SyntaxError("Invalid token");
     }
@@ -77,7 +102,7 @@ ValuePtr Parser::parseTails(){
     }
     if(tokens.front()->getType() == TokenType::RIGHT_PAREN){
         tokens.pop_front();
-        return std::make_shared<NilValue>();
+        return ValuePtr::nil();
     } 
     auto car = this->parse();
     if(tokens.empty()){
@@ -92,10 +117,10 @@ ValuePtr Parser::parseTails(){
        }
 
         tokens.pop_front();
-        return std::make_shared<PairValue>(car, cdr);
+        return makeValue<PairValue>(car, cdr);
     }
     else{
         auto cdr = this->parseTails();
-        return std::make_shared<PairValue>(car, cdr);
+        return makeValue<PairValue>(car, cdr);
    }
 }
\ No newline at end of file
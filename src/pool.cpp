@@ -0,0 +1,13 @@
+#include "./pool.h"
+
+// Each chunk holds many blocks of one size class.
+static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+void* Pool::refill(size_t index){
+    auto& sizeClass = classes[index];
+    auto size = blockSize(index);
+    auto chunk = static_cast<char*>(::operator new(CHUNK_SIZE));
+    sizeClass.bump = chunk + size;
+    sizeClass.end = chunk + CHUNK_SIZE - CHUNK_SIZE % size;
+    return chunk;
+}
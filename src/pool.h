@@ -0,0 +1,79 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <new>
+
+// Memory for small heap objects. Blocks are grouped into size classes of
+// GRANULE bytes; each class carves its blocks out of large chunks by
+// bumping a pointer, and keeps the blocks it gets back on a free list to
+// hand out again first. Objects allocated one after another, like the cells
+// of a list being built, therefore end up next to each other in memory.
+// Chunks are never returned to the system. Larger requests go straight to
+// the global operator new.
+class Pool {
+public:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_SIZE = 128;
+
+    static void* allocate(size_t size) {
+        if (size > MAX_SIZE)
+            return ::operator new(size);
+        auto index = classOf(size);
+        auto& sizeClass = classes[index];
+        if (auto block = sizeClass.free) {
+            sizeClass.free = block->next;
+            return block;
+        }
+        if (sizeClass.bump != sizeClass.end) {
+            auto block = sizeClass.bump;
+            sizeClass.bump += blockSize(index);
+            return block;
+        }
+        return refill(index);
+    }
+    static void deallocate(void* block, size_t size) {
+        if (size > MAX_SIZE) {
+            ::operator delete(block);
+            return;
+        }
+        auto& sizeClass = classes[classOf(size)];
+        auto freed = static_cast<FreeBlock*>(block);
+        freed->next = sizeClass.free;
+        sizeClass.free = freed;
+    }
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct SizeClass {
+        FreeBlock* free;
+        char* bump;
+        char* end;
+    };
+    static constexpr size_t CLASSES = MAX_SIZE / GRANULE;
+    static constexpr size_t classOf(size_t size) {return size == 0 ? 0 : (size - 1) / GRANULE;}
+    static constexpr size_t blockSize(size_t index) {return (index + 1) * GRANULE;}
+    // Zero-initialized before any dynamic initialization runs, so objects
+    // created by static initializers can already be pooled.
+    static inline constinit SizeClass classes[CLASSES] {};
+    static void* refill(size_t index);
+};
+
+// Lets a standard container keep its elements in the pool, for small arrays
+// that come and go as often as the objects themselves.
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+    T* allocate(size_t n) {return static_cast<T*>(Pool::allocate(n * sizeof(T)));}
+    void deallocate(T* block, size_t n) {Pool::deallocate(block, n * sizeof(T));}
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const {return true;}
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const {return false;}
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "./profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MINI_LISP_PROFILER
+#include <csignal>
+#include <sys/time.h>
+#endif
+
+std::vector<Symbol> Profiler::stack;
+
+namespace {
+
+// Microseconds between timer signals, in processor time.
+constexpr long INTERVAL = 1000;
+
+struct Totals {
+    uint64_t calls = 0;
+    double self = 0;
+    double inclusive = 0;
+};
+
+std::string output;
+std::unordered_map<Symbol, Totals> totals;
+std::map<std::string, uint64_t> folded;
+double lastSample = 0;
+
+double cpuSeconds(){
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+}
+
+void Profiler::handleSignal(int){
+    pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Profiler::start(const std::string& path){
+#ifdef MINI_LISP_PROFILER
+    output = path;
+    stack.reserve(256);
+    struct sigaction action {};
+    action.sa_handler = handleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+    itimerval timer {{0, INTERVAL}, {0, INTERVAL}};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    lastSample = cpuSeconds();
+    std::atexit(report);
+    on = true;
+#endif
+    return on;
+}
+
+// The stack is still the one the pending samples were taken on, since it
+// has not changed since the signal; the time is what has passed since the
+// samples before them.
+void Profiler::record(){
+    uint32_t samples = pending.exchange(0, std::memory_order_relaxed);
+    double now = cpuSeconds();
+    double elapsed = now - lastSample;
+    lastSample = now;
+    if (stack.empty())
+        return;
+    std::string key;
+    std::unordered_set<Symbol> seen;
+    for (const auto& name : stack) {
+        if (!key.empty())
+            key += ';';
+        key += name.str();
+        if (seen.insert(name).second)
+            totals[name].inclusive += elapsed;
+    }
+    totals[stack.back()].self += elapsed;
+    folded[key] += samples;
+}
+
+void Profiler::enter(Symbol name){
+    if (pending.load(std::memory_order_relaxed))
+        record();
+    stack.push_back(name);
+    totals[name].calls++;
+}
+
+void Profiler::replace(Symbol name){
+    if (pending.load(std::memory_order_relaxed))
+        record();
+    stack.back() = name;
+    totals[name].calls++;
+}
+
+void Profiler::leave(){
+    if (pending.load(std::memory_order_relaxed))
+        record();
+    stack.pop_back();
+}
+
+void Profiler::unwind(size_t depth){
+    if (stack.size() <= depth)
+        return;
+    if (pending.load(std::memory_order_relaxed))
+        record();
+    stack.erase(stack.begin() + depth, stack.end());
+}
+
+void Profiler::report(){
+#ifdef MINI_LISP_PROFILER
+    itimerval off {};
+    setitimer(ITIMER_PROF, &off, nullptr);
+#endif
+    on = false;
+    std::ofstream file(output);
+    for (const auto& [key, samples] : folded)
+        file << key << ' ' << samples << '\n';
+    if (!file)
+        std::cerr << "Error: Cannot write profile to " << output << std::endl;
+
+    std::vector<std::pair<Symbol, Totals>> rows(totals.begin(), totals.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& x, const auto& y){
+        return x.second.self != y.second.self ? x.second.self > y.second.self
+                                              : x.second.calls > y.second.calls;
+    });
+    std::cerr << std::setw(12) << "calls" << std::setw(12) << "self ms" << std::setw(12) << "total ms"
+              << "  procedure\n" << std::fixed << std::setprecision(1);
+    for (const auto& [name, row] : rows)
+        std::cerr << std::setw(12) << row.calls << std::setw(12) << row.self * 1000
+                  << std::setw(12) << row.inclusive * 1000 << "  " << name.str() << '\n';
+}
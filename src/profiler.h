@@ -0,0 +1,59 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "./symbol.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// The sampling profiler behind --profile. While it runs, the evaluators
+// keep a shadow stack of the Lisp procedures being called: lambdas by the
+// name define gave them, builtins by their global name. A SIGPROF timer
+// only marks a sample as due; the next time the shadow stack changes, the
+// stack as it stood when the timer fired is recorded, with the processor
+// time since the last sample. On exit it writes every sampled stack in the
+// folded format flame graph tools read, and prints the calls, self time
+// and inclusive time of each procedure to stderr.
+//
+// Every hook is behind enabled(), so a run without --profile only pays for
+// that test.
+class Profiler {
+private:
+    static inline bool on = false;
+    static inline std::atomic<uint32_t> pending {0};
+    static std::vector<Symbol> stack;
+    static void handleSignal(int);
+    static void record();
+    static void report();
+public:
+    // False, and nothing is profiled, where there is no SIGPROF timer.
+    static bool start(const std::string& path);
+    static bool enabled() {return on;}
+
+    static size_t depth() {return stack.size();}
+    static void enter(Symbol name);
+    // A tail call: the procedure on top is replaced by name.
+    static void replace(Symbol name);
+    static void leave();
+    // Pops every frame above depth.
+    static void unwind(size_t depth);
+
+    // Pops whatever was pushed after it, however its scope is left.
+    class Mark {
+    private:
+        size_t depth;
+    public:
+        Mark() : depth{Profiler::depth()} {}
+        ~Mark() {Profiler::unwind(depth);}
+        Mark(const Mark&) = delete;
+        Mark& operator=(const Mark&) = delete;
+        bool entered() const {return Profiler::depth() > depth;}
+    };
+    // A frame for name for as long as it lives.
+    class Frame : public Mark {
+    public:
+        Frame(Symbol name) {enter(name);}
+    };
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "./stats.h"
+#include "./value.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Indexed by ValueType.
+constexpr const char* TYPE_NAMES[] = {
+    "boolean", "numeric", "string", "symbol", "nil",
+    "pair", "builtin", "lambda", "promise", "f64vector",
+    "vector", "hash-table", "pmap", "pset",
+};
+static_assert(std::size(TYPE_NAMES) == VALUE_TYPES && VALUE_TYPES <= Stats::MAX_TYPES);
+
+constexpr const char* COUNTER_NAMES[] = {
+    "environments", "eval-calls", "apply-calls", "to-vector-calls", "tokens",
+};
+static_assert(std::size(COUNTER_NAMES) == Stats::COUNTERS);
+
+}
+
+std::vector<std::pair<std::string, uint64_t>> Stats::snapshot(){
+    std::vector<std::pair<std::string, uint64_t>> result;
+#ifdef MINI_LISP_STATS
+    for (size_t i = 0; i < VALUE_TYPES; i++)
+        result.emplace_back(std::string(TYPE_NAMES[i]) + "-allocations", allocations[i]);
+    for (size_t i = 0; i < COUNTERS; i++)
+        result.emplace_back(COUNTER_NAMES[i], counters[i]);
+#endif
+    return result;
+}
+
+void Stats::print(){
+    for (const auto& [name, count] : snapshot())
+        std::cerr << std::setw(14) << count << "  " << name << '\n';
+}
+
+bool Stats::printAtExit(){
+    if (enabled())
+        std::atexit(print);
+    return enabled();
+}
@@ -0,0 +1,60 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Builds configured with MINI_LISP_STATS (the default) count what the
+// interpreter does: heap values allocated of each type, environments
+// created, evaluator entries, procedure calls, list-to-vector copies and
+// tokens read. An evaluator entry is one non-tail evaluation of a compound
+// expression on the tree-walker, and one run of the bytecode loop on the
+// VM, which only starts a new one for top-level forms and for procedures
+// called from builtins.
+// (runtime-stats) and --stats report them. Without it every count is an
+// empty inline function and compiles away.
+class Stats {
+public:
+    enum Counter {
+        ENVIRONMENTS,
+        EVAL,
+        APPLY,
+        TO_VECTOR,
+        TOKENS,
+        COUNTERS
+    };
+    // Heap allocations are counted by ValueType, which is below this.
+    static constexpr size_t MAX_TYPES = 32;
+private:
+#ifdef MINI_LISP_STATS
+    static inline std::array<uint64_t, COUNTERS> counters {};
+    static inline std::array<uint64_t, MAX_TYPES> allocations {};
+#endif
+    static void print();
+public:
+    static constexpr bool enabled() {
+#ifdef MINI_LISP_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+#ifdef MINI_LISP_STATS
+    static void count(Counter counter) {counters[counter]++;}
+    static void allocated(size_t type) {allocations[type]++;}
+#else
+    static void count(Counter) {}
+    static void allocated(size_t) {}
+#endif
+    // Every counter by name, allocations first as "<type>-allocations".
+    static std::vector<std::pair<std::string, uint64_t>> snapshot();
+    // Prints the counters to stderr when the program exits; false when
+    // they are compiled out.
+    static bool printAtExit();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "./symbol.h"
+#include <unordered_set>
+
+namespace {
+
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const noexcept {
+        return std::hash<std::string_view>{}(name);
+    }
+};
+
+using SymbolTable = std::unordered_set<std::string, NameHash, std::equal_to<>>;
+
+}
+
+// Node-based, so the address of every entry stays put as the table grows.
+// A function-local static, so other globals can intern during startup.
+static SymbolTable& table(){
+    static SymbolTable symbols;
+    return symbols;
+}
+
+Symbol Symbol::intern(std::string_view name){
+    auto& symbols = table();
+    auto found = symbols.find(name);
+    if (found == symbols.end())
+        found = symbols.emplace(name).first;
+    return Symbol(&*found);
+}
+
+size_t Symbol::tableSize(){
+    return table().size();
+}
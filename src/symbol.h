@@ -0,0 +1,34 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// An interned name. The symbol table keeps exactly one entry per distinct
+// spelling and never frees it, so two Symbols name the same thing exactly
+// when they point at the same entry: comparing and hashing them never looks
+// at the characters.
+class Symbol {
+private:
+    const std::string* name;
+    explicit Symbol(const std::string* name) : name{name} {}
+public:
+    static Symbol intern(std::string_view name);
+    // Number of distinct symbols interned so far.
+    static size_t tableSize();
+
+    const std::string& str() const {return *name;}
+    const void* id() const {return name;}
+    bool operator==(const Symbol& other) const {return name == other.name;}
+};
+
+template <>
+struct std::hash<Symbol> {
+    size_t operator()(const Symbol& symbol) const noexcept {
+        return std::hash<const void*>{}(symbol.id());
+    }
+};
+
+#endif
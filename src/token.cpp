@@ -23,6 +23,14 @@ TokenPtr Token::dot() {
     return TokenPtr(new Token(TokenType::DOT));
 }
 
+TokenPtr Token::f64VectorOpen() {
+    return TokenPtr(new Token(TokenType::F64VECTOR_OPEN));
+}
+
+TokenPtr Token::vectorOpen() {
+    return TokenPtr(new Token(TokenType::VECTOR_OPEN));
+}
+
 std::string Token::toString() const {
     switch (type) {
         case TokenType::LEFT_PAREN: return "(LEFT_PAREN)"; break;
@@ -31,6 +39,8 @@ std::string Token::toString() const {
         case TokenType::QUASIQUOTE: return "(QUASIQUOTE)"; break;
         case TokenType::UNQUOTE: return "(UNQUOTE)"; break;
         case TokenType::DOT: return "(DOT)"; break;
+        case TokenType::F64VECTOR_OPEN: return "(F64VECTOR_OPEN)"; break;
+        case TokenType::VECTOR_OPEN: return "(VECTOR_OPEN)"; break;
         default: return "(UNKNOWN)";
     }
 }
@@ -50,6 +60,9 @@ std::string BooleanLiteralToken::toString() const {
 }
 
 std::string NumericLiteralToken::toString() const {
+    if (integer) {
+        return "(NUMERIC_LITERAL " + *integer + ")";
+    }
     return "(NUMERIC_LITERAL " + std::to_string(value) + ")";
 }
 
@@ -1,6 +1,7 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdlib>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -17,6 +18,8 @@ enum class TokenType {
     NUMERIC_LITERAL,
     STRING_LITERAL,
     IDENTIFIER,
+    F64VECTOR_OPEN,
+    VECTOR_OPEN,
 };
 
 class Token;
@@ -34,6 +37,10 @@ public:
 
     static TokenPtr fromChar(char c);
     static TokenPtr dot();
+    // The #f64( that opens an f64vector literal.
+    static TokenPtr f64VectorOpen();
+    // The #( that opens a vector literal.
+    static TokenPtr vectorOpen();
 
     TokenType getType() const {
         return type;
@@ -56,16 +63,25 @@ public:
     std::string toString() const override;
 };
 
+// Either an exact integer literal, kept as its digits since it may be of
+// any size, or an inexact one.
 class NumericLiteralToken : public Token {
 private:
     double value;
+    std::optional<std::string> integer;
 
 public:
     NumericLiteralToken(double value) : Token(TokenType::NUMERIC_LITERAL), value{value} {}
+    // strtod rather than stod: an integer past the range of a double is
+    // still a valid literal, and only its approximate value overflows.
+    NumericLiteralToken(std::string integer) : Token(TokenType::NUMERIC_LITERAL), value{std::strtod(integer.c_str(), nullptr)}, integer{std::move(integer)} {}
 
     double getValue() const {
         return value;
     }
+    const std::optional<std::string>& getInteger() const {
+        return integer;
+    }
     std::string toString() const override;
 };
 
@@ -1,10 +1,12 @@
 #include "./tokenizer.h"
 
+#include <algorithm>
 #include <cctype>
 #include <set>
 #include <stdexcept>
 
 #include "./error.h"
+#include "./stats.h"
 
 const std::set<char> TOKEN_END{'(', ')', '\'', '`', ',', '"'};
 
@@ -21,7 +23,13 @@ TokenPtr Tokenizer::nextToken(int& pos) {
             pos++;
             return token;
         } else if (c == '#') {
-            if (auto result = BooleanLiteralToken::fromChar(input[pos + 1])) {
+            if (input.compare(pos, 5, "#f64(") == 0) {
+                pos += 5;
+                return Token::f64VectorOpen();
+            } else if (input.compare(pos, 2, "#(") == 0) {
+                pos += 2;
+                return Token::vectorOpen();
+            } else if (auto result = BooleanLiteralToken::fromChar(input[pos + 1])) {
                 pos += 2;
                 return result;
             } else {
@@ -62,6 +70,11 @@ TokenPtr Tokenizer::nextToken(int& pos) {
                 return Token::dot();
             }
             if (std::isdigit(text[0]) || text[0] == '+' || text[0] == '-' || text[0] == '.') {
+                // Literals that are whole integers are exact.
+                auto digits = text[0] == '+' || text[0] == '-' ? text.substr(1) : text;
+                if (!digits.empty() && std::all_of(digits.begin(), digits.end(), [](char c) { return std::isdigit(c); })) {
+                    return std::make_unique<NumericLiteralToken>(text);
+                }
                 try {
                     return std::make_unique<NumericLiteralToken>(std::stod(text));
                 } catch (std::invalid_argument& e) {
@@ -82,6 +95,7 @@ std::deque<TokenPtr> Tokenizer::tokenize() {
             break;
         }
         tokens.push_back(std::move(token));
+        Stats::count(Stats::TOKENS);
     }
     return tokens;
 }
@@ -1,58 +1,241 @@
 #include "./value.h"
 #include "./error.h"
 #include "./eval_env.h"
+#include "./node.h"
+#include "./vm.h"
+#include "./jit.h"
+#include "./equality.h"
+#include <cmath>
 #include <iomanip>
+#include <limits>
 #include <string>
 #include <sstream>
 
-class EvalEnv;
-
-std::string BooleanValue::toString() const {
-    return value ? "#t" : "#f";
-}
-
-std::string NumericValue::toString() const {
-    if(value == static_cast<int>(value))
+static std::string numberToString(double value){
+    if(std::trunc(value) == value && std::abs(value) <= std::numeric_limits<int>::max())
         return std::to_string(static_cast<int>(value));
     else
         return std::to_string(value);
 }
 
+ValuePtr ValuePtr::boxInteger(int64_t value){
+    return makeValue<IntegerValue>(BigInt(value));
+}
+
+ValuePtr ValuePtr::integer(const BigInt& value){
+    if (value.fitsInt64())
+        return integer(value.toInt64());
+    return makeValue<IntegerValue>(value);
+}
+
+std::string ValuePtr::toString() const {
+    if (isDouble())
+        return numberToString(asNumber());
+    if (isFixnum())
+        return std::to_string(asInteger());
+    if (auto object = get())
+        return object->toString();
+    if (isNil())
+        return "()";
+    return asBoolean() ? "#t" : "#f";
+}
+
+bool ValuePtr::isInteger() const {
+    if (isDouble())
+        return std::isfinite(asNumber()) && std::trunc(asNumber()) == asNumber();
+    return isExact();
+}
+
+bool ValuePtr::isSelfEvaluating() const {
+    auto type = getType();
+    return type == ValueType::BOOLEAN || type == ValueType::NUMERIC || type == ValueType::STRING || type == ValueType::BUILTIN_PROC || type == ValueType::LAMBDA || type == ValueType::PROMISE || type == ValueType::F64VECTOR || type == ValueType::VECTOR;
+}
+
+bool ValuePtr::isAtom() const {
+    auto type = getType();
+    return type == ValueType::BOOLEAN || type == ValueType::NUMERIC || type == ValueType::STRING || type == ValueType::SYMBOL || type == ValueType::NIL;
+}
+
+std::optional<Symbol> ValuePtr::asSymbol() const {
+    if (auto object = get())
+        return object->asSymbol();
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> ValuePtr::toVector() const {
+    if (auto object = get())
+        return object->toVector();
+    return {};
+}
+
 std::string StringValue::toString() const {
     std::ostringstream ss;
-    ss << std::quoted(value);
+    ss << std::quoted(getValue());
     return ss.str();
 }
 
-std::string SymbolValue::toString() const {
-    return value;
+ValuePtr StringValue::substring(size_t start, size_t end) const {
+    return makeValue<StringValue>(buffer, offset + start, end - start);
+}
+
+std::string IntegerValue::toString() const {
+    return value.toString();
 }
 
-std::string NilValue::toString() const {
-    return "()";
+std::string F64VectorValue::toString() const {
+    std::string result = "#f64(";
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (i > 0)
+            result += " ";
+        result += numberToString(elements[i]);
+    }
+    return result + ")";
+}
+
+std::string VectorValue::toString() const {
+    std::string result = "#(";
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (i > 0)
+            result += " ";
+        result += elements[i].toString();
+    }
+    return result + ")";
+}
+
+void VectorValue::trace(Tracer& tracer) const {
+    for (const auto& element : elements)
+        tracer.visit(element.get());
+}
+
+void VectorValue::clearReferences() {
+    elements.clear();
+}
+
+size_t HashTableValue::hash(const ValuePtr& key) const {
+    return kind == Kind::EQ ? Equality::hashEq(key) : Equality::hashEqual(key);
+}
+
+bool HashTableValue::same(const ValuePtr& x, const ValuePtr& y) const {
+    return kind == Kind::EQ ? Equality::eq(x, y) : Equality::equal(x, y);
+}
+
+size_t HashTableValue::probe(const ValuePtr& key, size_t hash) const {
+    size_t mask = entries.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const auto& entry = entries[i];
+        if (!entry.key && !entry.removed)
+            return i;
+        if (entry.key && entry.hash == hash && same(entry.key, key))
+            return i;
+    }
+}
+
+void HashTableValue::rehash(size_t capacity) {
+    auto old = std::exchange(entries, std::vector<Entry>(capacity));
+    used = count;
+    size_t mask = capacity - 1;
+    for (auto& entry : old) {
+        if (!entry.key)
+            continue;
+        size_t i = entry.hash & mask;
+        while (entries[i].key)
+            i = (i + 1) & mask;
+        entries[i] = std::move(entry);
+    }
+}
+
+const ValuePtr* HashTableValue::find(const ValuePtr& key) const {
+    const auto& entry = entries[probe(key, hash(key))];
+    return entry.key ? &entry.value : nullptr;
+}
+
+void HashTableValue::set(const ValuePtr& key, ValuePtr value) {
+    size_t h = hash(key);
+    size_t i = probe(key, h);
+    if (entries[i].key) {
+        entries[i].value = std::move(value);
+        return;
+    }
+    // At most three quarters full, counting tombstones, so probes stay
+    // short and always reach an empty entry.
+    if ((used + 1) * 4 > entries.size() * 3) {
+        rehash(count * 2 >= entries.size() ? entries.size() * 2 : entries.size());
+        i = probe(key, h);
+    }
+    entries[i] = {key, std::move(value), h, false};
+    count++;
+    used++;
+}
+
+bool HashTableValue::remove(const ValuePtr& key) {
+    auto& entry = entries[probe(key, hash(key))];
+    if (!entry.key)
+        return false;
+    entry = {nullptr, nullptr, 0, true};
+    count--;
+    return true;
+}
+
+std::vector<ValuePtr> HashTableValue::keys() const {
+    std::vector<ValuePtr> result;
+    result.reserve(count);
+    for (const auto& entry : entries)
+        if (entry.key)
+            result.push_back(entry.key);
+    return result;
+}
+
+std::string HashTableValue::toString() const {
+    return "#<HashTable (" + std::to_string(count) + " entries)>";
+}
+
+void HashTableValue::trace(Tracer& tracer) const {
+    for (const auto& entry : entries) {
+        tracer.visit(entry.key.get());
+        tracer.visit(entry.value.get());
+    }
+}
+
+void HashTableValue::clearReferences() {
+    entries.assign(8, Entry{});
+    count = used = 0;
+}
+
+std::string SymbolValue::toString() const {
+    return value.str();
 }
 
 std::string BuiltinProcValue::toString() const {
     return "#<BuiltinProcedure>";
 }
 
+Symbol BuiltinProcValue::getName() const {
+    static const Symbol anonymous = Symbol::intern("builtin");
+    return name.value_or(anonymous);
+}
+
+ValuePtr BuiltinProcValue::callProfiled(ValueSpan args, EvalEnv& env) const {
+    Profiler::Frame frame(getName());
+    return func(args, env);
+}
+
 std::string LambdaValue::toString() const {
     return "#<LambdaProcedure>";
 }
 
 std::string PairValue::toString() const {
-    std::string result = "(" + car->toString();
+    std::string result = "(" + car.toString();
     auto cdr = getCdr();
-    while (cdr->getType() == ValueType::PAIR || cdr->getType() == ValueType::NIL){
-        if (cdr->getType() == ValueType::NIL){
+    while (cdr.getType() == ValueType::PAIR || cdr.isNil()){
+        if (cdr.isNil()){
             result += ")";
             return result;
         }   
         auto pair = static_cast<PairValue*>(cdr.get());
-        result += " " + pair->getCar()->toString();
+        result += " " + pair->getCar().toString();
         cdr = pair->getCdr();
     }
-    result += " . " + cdr->toString() + ")";
+    result += " . " + cdr.toString() + ")";
     return result;
 }
 
@@ -63,13 +246,46 @@ std::string PromiseValue::toString() const{
     return "#<Promise" + forcedString + ">";
 }
 
+void PairValue::trace(Tracer& tracer) const {
+    tracer.visit(car.get());
+    tracer.visit(cdr.get());
+}
+
+void PairValue::clearReferences() {
+    car = nullptr;
+    cdr = nullptr;
+}
+
+LambdaValue::LambdaValue(std::shared_ptr<const LambdaNode> code, EnvPtr parent) : Value(ValueType::LAMBDA), code{std::move(code)}, parent{std::move(parent)} {}
+
+LambdaValue::~LambdaValue() = default;
+
+void LambdaValue::trace(Tracer& tracer) const {
+    tracer.visit(parent.get());
+}
+
+void LambdaValue::clearReferences() {
+    parent = nullptr;
+}
+
+void PromiseValue::trace(Tracer& tracer) const {
+    tracer.visit(thunk.get());
+    tracer.visit(value.get());
+}
+
+void PromiseValue::clearReferences() {
+    thunk = nullptr;
+    value = nullptr;
+}
+
 std::vector<ValuePtr> PairValue:: toVector() const {
+    Stats::count(Stats::TO_VECTOR);
     try{
         std::vector<ValuePtr> result;
         result.push_back(this->car);
         auto cdr = getCdr();
-        while (cdr->getType() == ValueType::PAIR || cdr->getType() == ValueType::NIL){
-            if (cdr->getType() == ValueType::NIL){
+        while (cdr.getType() == ValueType::PAIR || cdr.isNil()){
+            if (cdr.isNil()){
                 return result;
             }
             auto pair = static_cast<PairValue*>(cdr.get());
@@ -84,35 +300,43 @@ std::vector<ValuePtr> PairValue:: toVector() const {
     }
 }
 
-std::vector<std::string> LambdaValue::getParams() const {
-    std::vector<std::string> result;
-    for(const auto& param : params){
-        auto symbol = param->asSymbol();
-        if(!symbol){
-            throw LispError("Invalid parameter list");
-        }
-        result.push_back(*symbol);
+EnvPtr LambdaValue::bind(Slots args) const {
+    if(args.size() != code->getArity()){
+        throw LispError("Incorrect number of arguments");
     }
-    return result;
+    Stats::count(Stats::APPLY);
+    return parent->createChild(code->getScope(), std::move(args));
 }
 
-ValuePtr LambdaValue::apply(const std::vector<ValuePtr>& args){
-    if(args.size() != params.size()){
-        throw LispError("Incorrect number of arguments");
-    }
-    auto child = parent->createChild(getParams(), args);
-    ValuePtr result = nullptr;
-    for(const auto& expr : body){
-        result = child->eval(expr);
-    }
-    return result;
+const Node* LambdaValue::getBody() const {
+    return code->getBody().get();
+}
+
+ValuePtr LambdaValue::apply(ValueSpan args){
+    if (Jit::enabled())
+        if (auto result = Jit::call(*this, args))
+            return result;
+    std::optional<Profiler::Frame> frame;
+    if (Profiler::enabled())
+        frame.emplace(code->getName());
+    auto child = bind(Slots(args.begin(), args.end()));
+    if (EvalEnv::getEngine() == Engine::VM)
+        return VM::run(code->compiled(), std::move(child));
+    return code->getBody()->eval(*child);
 }
 
 ValuePtr PromiseValue::force(){
     if(forced){
         return value;
     }
-    forced = true;
-    value = env->eval(value);
+    // A thunk that forces this promise again clears thunk before it returns,
+    // so the running procedure is kept alive by a reference of its own.
+    ValuePtr thunk = this->thunk;
+    auto result = static_cast<LambdaValue*>(thunk.get())->apply({});
+    if(!forced){
+        value = std::move(result);
+        forced = true;
+        thunk = nullptr;
+    }
     return value;
 }
\ No newline at end of file
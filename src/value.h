@@ -2,12 +2,26 @@
 #define VALUE_H
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <optional>
 #include <ostream>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <initializer_list>
+#include "./bigint.h"
+#include "./symbol.h"
+#include "./gc.h"
+#include "./profiler.h"
+#include "./stats.h"
 
 class EvalEnv;
+class Node;
+class LambdaNode;
+
+using EnvPtr = GcRef<EvalEnv>;
 
 enum class ValueType{
     BOOLEAN,
@@ -18,89 +32,286 @@ enum class ValueType{
     PAIR,
     BUILTIN_PROC,
     LAMBDA,
-    PROMISE
+    PROMISE,
+    F64VECTOR,
+    VECTOR,
+    HASH_TABLE,
+    PMAP,
+    PSET
 };
 
+// How many ValueTypes there are, for tables indexed by type.
+constexpr size_t VALUE_TYPES = static_cast<size_t>(ValueType::PSET) + 1;
+
 class Value;
-using ValuePtr = std::shared_ptr<Value>;
-using BuiltinFuncType = ValuePtr(const std::vector<ValuePtr>&, EvalEnv&);
 
-class Value{
+// A Lisp value in one 64-bit word, NaN-boxed. Any bit pattern outside the
+// quiet-NaN space marked by BOX is a double stored as itself; every NaN a
+// computation produces is folded to one canonical NaN that also lies
+// outside it. Inside it, the sign bit set means the low 48 bits point at a
+// heap Value, and otherwise the two bits above the payload are a tag:
+//
+//   SIGN | BOX | pointer      heap object (null pointer: no value at all)
+//   BOX | SPECIAL | 0 1 2     () #f #t
+//   BOX | FIXNUM | integer    exact integer, 48-bit two's complement
+//
+// Numbers are either inexact doubles or exact integers of any size. Exact
+// integers too wide for a fixnum are IntegerValues on the heap; integer()
+// picks the representation, so a given integer only ever has one. Doubles, fixnums,
+// booleans and nil never touch the heap. Heap objects carry the intrusive,
+// non-atomic reference count of GcObject, which ValuePtr maintains.
+class ValuePtr {
 private:
-    ValueType type;
-protected:
-    Value(ValueType type) : type{type} {}
+    static constexpr uint64_t SIGN = 0x8000000000000000ull;
+    static constexpr uint64_t BOX = 0x7ffc000000000000ull;
+    static constexpr uint64_t OBJECT = SIGN | BOX;
+    static constexpr uint64_t PAYLOAD = 0x0000ffffffffffffull;
+    static constexpr uint64_t TAG = 0x0003000000000000ull;
+    static constexpr uint64_t SPECIAL = 0x0001000000000000ull;
+    static constexpr uint64_t FIXNUM = 0x0002000000000000ull;
+    static constexpr uint64_t CANONICAL_NAN = 0x7ff8000000000000ull;
+    static constexpr uint64_t NIL_BITS = BOX | SPECIAL | 0;
+    static constexpr uint64_t FALSE_BITS = BOX | SPECIAL | 1;
+    static constexpr uint64_t TRUE_BITS = BOX | SPECIAL | 2;
+
+    uint64_t bits;
+
+    explicit ValuePtr(uint64_t bits, int) : bits{bits} {}
+    static ValuePtr boxInteger(int64_t value);
+    void retain() const;
+    void release() const;
 public:
-    virtual ~Value() = default;
+    ValuePtr() : bits{OBJECT} {}
+    ValuePtr(std::nullptr_t) : bits{OBJECT} {}
+    // Takes a reference to a heap object; see makeValue.
+    explicit ValuePtr(Value* object) : bits{OBJECT | reinterpret_cast<uint64_t>(object)} {retain();}
+    ValuePtr(const ValuePtr& other) : bits{other.bits} {retain();}
+    ValuePtr(ValuePtr&& other) noexcept : bits{other.bits} {other.bits = OBJECT;}
+    // other may live inside the object being released, so it is read first.
+    ValuePtr& operator=(const ValuePtr& other) {
+        auto next = other.bits;
+        other.retain();
+        release();
+        bits = next;
+        return *this;
+    }
+    ValuePtr& operator=(ValuePtr&& other) noexcept {
+        if (this != &other) {
+            auto next = std::exchange(other.bits, OBJECT);
+            release();
+            bits = next;
+        }
+        return *this;
+    }
+    ~ValuePtr() {release();}
 
-    virtual bool isInteger() const = 0;
-    virtual std::string toString() const = 0;
-    ValueType getType() const {
-        return type;
+    static constexpr int64_t FIXNUM_MIN = -(int64_t{1} << 47);
+    static constexpr int64_t FIXNUM_MAX = (int64_t{1} << 47) - 1;
+
+    // An inexact number.
+    static ValuePtr number(double value) {
+        uint64_t raw;
+        std::memcpy(&raw, &value, sizeof raw);
+        if (value != value)
+            raw = CANONICAL_NAN;
+        return ValuePtr(raw, 0);
     }
-    bool isBoolean() const {return type == ValueType::BOOLEAN;}
-    bool isNil() const {return type == ValueType::NIL;}
-    bool isNumber() const {return type == ValueType::NUMERIC;}
-    bool isSelfEvaluating() const {
-        return type == ValueType::BOOLEAN || type == ValueType::NUMERIC || type == ValueType::STRING || type == ValueType::BUILTIN_PROC || type == ValueType::LAMBDA || type == ValueType::PROMISE;
+    // The canonical (), #t and #f: there are no others, so they compare by
+    // identity and creating them allocates nothing.
+    static ValuePtr boolean(bool value) {return ValuePtr(value ? TRUE_BITS : FALSE_BITS, 0);}
+    static ValuePtr nil() {return ValuePtr(NIL_BITS, 0);}
+    // An exact integer.
+    static ValuePtr integer(int64_t value) {
+        if (value < FIXNUM_MIN || value > FIXNUM_MAX)
+            return boxInteger(value);
+        return ValuePtr(BOX | FIXNUM | (static_cast<uint64_t>(value) & PAYLOAD), 0);
     }
-    bool isAtom() const {
-        return type == ValueType::BOOLEAN || type == ValueType::NUMERIC || type == ValueType::STRING || type == ValueType::SYMBOL || type == ValueType::NIL;
+    static ValuePtr integer(const BigInt& value);
+
+    bool isDouble() const {return (bits & BOX) != BOX;}
+    bool isFixnum() const {return (bits & (SIGN | BOX | TAG)) == (BOX | FIXNUM);}
+    bool isExact() const;
+    // An exact integer that fits in an int64_t, so asInteger() holds it.
+    bool isInt64() const;
+    bool isNumber() const {return isDouble() || isExact();}
+    bool isObject() const {return (bits & OBJECT) == OBJECT;}
+    bool isBoolean() const {return bits == TRUE_BITS || bits == FALSE_BITS;}
+    bool isNil() const {return bits == NIL_BITS;}
+    bool isFalse() const {return bits == FALSE_BITS;}
+    explicit operator bool() const {return bits != OBJECT;}
+
+    // Any number, converted to a double if it is exact.
+    double asNumber() const;
+    // The value of an exact integer that fits in an int64_t.
+    int64_t asInteger() const;
+    BigInt asBigInt() const;
+    bool asBoolean() const {return bits == TRUE_BITS;}
+    // The heap object, or null for an immediate.
+    Value* get() const {
+        return isObject() ? reinterpret_cast<Value*>(bits & PAYLOAD) : nullptr;
     }
-    virtual std::optional<std::string> asSymbol() const {return std::nullopt;};
-    virtual std::vector<ValuePtr> toVector() const {return {};};
+    uint64_t raw() const {return bits;}
+
+    ValueType getType() const;
+    bool isInteger() const;
+    bool isSelfEvaluating() const;
+    bool isAtom() const;
+    std::string toString() const;
+    std::optional<Symbol> asSymbol() const;
+    std::vector<ValuePtr> toVector() const;
+
+    // Identity: the same immediate, or the same heap object.
+    bool operator==(const ValuePtr& other) const {return bits == other.bits;}
 };
 
-class BooleanValue : public Value {
+// A read-only view of consecutive arguments: part of a vector, of the VM's
+// value stack, or of a braced list in a direct call. It never owns them.
+class ValueSpan {
 private:
-    bool value;
+    const ValuePtr* first;
+    size_t count;
 public:
-    BooleanValue(bool value) : Value(ValueType::BOOLEAN), value{value} {}
-
-    bool getValue() const {return value;}
-    bool isInteger() const override { return false; }
-    std::string toString() const override;
+    ValueSpan(const ValuePtr* first, size_t count) : first{first}, count{count} {}
+    template <typename Allocator>
+    ValueSpan(const std::vector<ValuePtr, Allocator>& values) : first{values.data()}, count{values.size()} {}
+    ValueSpan(std::initializer_list<ValuePtr> values) : first{values.begin()}, count{values.size()} {}
+    size_t size() const {return count;}
+    bool empty() const {return count == 0;}
+    const ValuePtr& operator[](size_t index) const {return first[index];}
+    const ValuePtr* begin() const {return first;}
+    const ValuePtr* end() const {return first + count;}
 };
 
-class NumericValue : public Value {
+// The slots of a local frame, which start out as the arguments of the call
+// that creates it. Most frames are small enough to come from the pool.
+using Slots = std::vector<ValuePtr, PoolAllocator<ValuePtr>>;
+
+// The general entry point of a builtin, and the optional ones for exactly
+// one or two arguments that calls with those counts use instead.
+using BuiltinFuncType = ValuePtr(ValueSpan, EvalEnv&);
+using BuiltinUnaryType = ValuePtr(const ValuePtr&, EvalEnv&);
+using BuiltinBinaryType = ValuePtr(const ValuePtr&, const ValuePtr&, EvalEnv&);
+
+// Base of every Lisp value that lives on the heap. Numbers, booleans and
+// nil are immediates inside ValuePtr and have no class of their own.
+class Value : public GcObject {
 private:
-    double value;
+    ValueType type;
+protected:
+    Value(ValueType type) : type{type} {
+        Stats::allocated(static_cast<size_t>(type));
+    }
 public:
-    NumericValue(double value) : Value(ValueType::NUMERIC), value{value} {}
 
-    double asNumber() const {return value;}
-    bool isInteger() const override {return value == static_cast<int>(value);}
-    std::string toString() const override;
+    virtual std::string toString() const = 0;
+    ValueType getType() const {
+        return type;
+    }
+    virtual std::optional<Symbol> asSymbol() const {return std::nullopt;};
+    virtual std::vector<ValuePtr> toVector() const {return {};};
 };
 
-class StringValue : public Value {
+inline void ValuePtr::retain() const {
+    if (auto object = get())
+        object->refs++;
+}
+
+inline void ValuePtr::release() const {
+    if (auto object = get())
+        if (--object->refs == 0)
+            Heap::destroy(object);
+}
+
+template <typename T, typename... Args>
+ValuePtr makeValue(Args&&... args) {
+    ValuePtr value(new T(std::forward<Args>(args)...));
+    Heap::allocated();
+    return value;
+}
+
+inline ValueType ValuePtr::getType() const {
+    if (isDouble() || isFixnum())
+        return ValueType::NUMERIC;
+    if (auto object = get())
+        return object->getType();
+    return isNil() ? ValueType::NIL : ValueType::BOOLEAN;
+}
+
+// An exact integer outside the fixnum range.
+class IntegerValue : public Value {
 private:
-    std::string value;
+    BigInt value;
 public:
-    StringValue(std::string value) : Value(ValueType::STRING), value{value} {}
+    IntegerValue(BigInt value) : Value(ValueType::NUMERIC), value{std::move(value)} {}
 
-    bool isInteger() const override { return false; }
-    std::string getValue() const {return value;}
+    const BigInt& getValue() const {return value;}
     std::string toString() const override;
 };
 
-class SymbolValue : public Value {
+inline bool ValuePtr::isExact() const {
+    if (isFixnum())
+        return true;
+    auto object = get();
+    return object && object->getType() == ValueType::NUMERIC;
+}
+
+inline bool ValuePtr::isInt64() const {
+    return isFixnum() || (isExact() && static_cast<IntegerValue*>(get())->getValue().fitsInt64());
+}
+
+inline int64_t ValuePtr::asInteger() const {
+    if (isFixnum())
+        return static_cast<int64_t>(bits << 16) >> 16;
+    return static_cast<IntegerValue*>(get())->getValue().toInt64();
+}
+
+inline BigInt ValuePtr::asBigInt() const {
+    if (isFixnum())
+        return BigInt(asInteger());
+    return static_cast<IntegerValue*>(get())->getValue();
+}
+
+inline double ValuePtr::asNumber() const {
+    if (isDouble()) {
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+    if (isFixnum())
+        return static_cast<double>(asInteger());
+    return static_cast<IntegerValue*>(get())->getValue().toDouble();
+}
+
+// An immutable string: a range of a reference-counted buffer that any
+// number of strings may share, so taking a substring copies nothing.
+class StringValue : public Value {
 private:
-    std::string value;
+    std::shared_ptr<const std::string> buffer;
+    size_t offset;
+    size_t length;
 public:
-    SymbolValue(std::string value) : Value(ValueType::SYMBOL), value{value} {}
+    StringValue(std::string value)
+        : Value(ValueType::STRING), buffer{std::make_shared<const std::string>(std::move(value))},
+          offset{0}, length{buffer->size()} {}
+    StringValue(std::shared_ptr<const std::string> buffer, size_t offset, size_t length)
+        : Value(ValueType::STRING), buffer{std::move(buffer)}, offset{offset}, length{length} {}
 
-    bool isInteger() const override { return false; }
+    // Valid for as long as this string is.
+    std::string_view getValue() const {return std::string_view(*buffer).substr(offset, length);}
+    size_t size() const {return length;}
+    // Characters [start, end), sharing this string's buffer.
+    ValuePtr substring(size_t start, size_t end) const;
     std::string toString() const override;
-    std::optional<std::string> asSymbol() const override { return value; }
 };
 
-class NilValue : public Value {
+class SymbolValue : public Value {
+private:
+    Symbol value;
 public:
-    NilValue() : Value(ValueType::NIL) {}
+    SymbolValue(Symbol value) : Value(ValueType::SYMBOL), value{value} {}
 
-    bool isInteger() const override { return false; }
     std::string toString() const override;
+    std::optional<Symbol> asSymbol() const override { return value; }
 };
 
 class PairValue : public Value {
@@ -110,50 +321,152 @@ private:
 public:
     PairValue(ValuePtr car, ValuePtr cdr) : Value(ValueType::PAIR), car{car}, cdr{cdr} {}
 
-    bool isInteger() const override { return false; }
-    ValuePtr getCar() const {return car;}
-    ValuePtr getCdr() const {return cdr;}
+    const ValuePtr& getCar() const {return car;}
+    const ValuePtr& getCdr() const {return cdr;}
     void setCar(ValuePtr value) {car = value;}
     void setCdr(ValuePtr value) {cdr = value;}
     std::string toString() const override;
     std::vector<ValuePtr> toVector() const override;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
 };
 
 class BuiltinProcValue : public Value {
 private:
     BuiltinFuncType* func;
+    BuiltinUnaryType* unary;
+    BuiltinBinaryType* binary;
+    std::optional<Symbol> name;
 public:
-    BuiltinProcValue(BuiltinFuncType* f) : Value(ValueType::BUILTIN_PROC), func{f} {}
-    
-    bool isInteger() const override { return false; }
+    BuiltinProcValue(BuiltinFuncType* f, BuiltinUnaryType* unary = nullptr, BuiltinBinaryType* binary = nullptr)
+        : Value(ValueType::BUILTIN_PROC), func{f}, unary{unary}, binary{binary} {}
+
     std::string toString() const override;
     auto getFunc() const {return func;}
+    // The global name it is bound to in the builtins frame, or builtin.
+    Symbol getName() const;
+    void setName(Symbol name) {this->name = name;}
+    ValuePtr call(ValueSpan args, EvalEnv& env) const {
+        Stats::count(Stats::APPLY);
+        if (Profiler::enabled()) [[unlikely]]
+            return callProfiled(args, env);
+        return func(args, env);
+    }
+    ValuePtr call(const ValuePtr& x, EvalEnv& env) const {
+        Stats::count(Stats::APPLY);
+        if (Profiler::enabled()) [[unlikely]]
+            return callProfiled(ValueSpan(&x, 1), env);
+        return unary ? unary(x, env) : func(ValueSpan(&x, 1), env);
+    }
+    ValuePtr call(const ValuePtr& x, const ValuePtr& y, EvalEnv& env) const {
+        Stats::count(Stats::APPLY);
+        if (Profiler::enabled()) [[unlikely]]
+            return callProfiled({x, y}, env);
+        return binary ? binary(x, y, env) : func({x, y}, env);
+    }
+    ValuePtr callProfiled(ValueSpan args, EvalEnv& env) const;
 };
-    
+
 class LambdaValue : public Value {
 private:
-    std::vector<ValuePtr> params;
-    std::vector<ValuePtr> body;
-    std::shared_ptr<EvalEnv> parent;
+    std::shared_ptr<const LambdaNode> code;
+    EnvPtr parent;
 public:
-    LambdaValue(std::vector<ValuePtr> params, std::vector<ValuePtr> body, std::shared_ptr<EvalEnv> parent) : Value(ValueType::LAMBDA), params{params}, body{body}, parent{parent} {}
-    bool isInteger() const override { return false; }
+    LambdaValue(std::shared_ptr<const LambdaNode> code, EnvPtr parent);
+    ~LambdaValue() override;
     std::string toString() const override;
-    ValuePtr apply(const std::vector<ValuePtr>& args);
-    std::vector<std::string> getParams() const;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+    ValuePtr apply(ValueSpan args);
+    EnvPtr bind(Slots args) const;
+    const Node* getBody() const;
+    const std::shared_ptr<const LambdaNode>& getCode() const {return code;}
+    const EnvPtr& getParent() const {return parent;}
 };
 
+// The delayed expression is kept as a procedure of no arguments, so forcing
+// it runs on whichever engine created it.
 class PromiseValue : public Value {
 private:
+    ValuePtr thunk;
     ValuePtr value;
     bool forced;
-    std::shared_ptr<EvalEnv> env;
 public:
-    PromiseValue(ValuePtr value, std::shared_ptr<EvalEnv> env) : Value(ValueType::PROMISE), value{value}, forced{false}, env{env} {}
+    PromiseValue(ValuePtr thunk) : Value(ValueType::PROMISE), thunk{std::move(thunk)}, value{nullptr}, forced{false} {}
 
-    bool isInteger() const override { return false; }
     std::string toString() const override;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
     ValuePtr force();
 };
 
-#endif
\ No newline at end of file
+// A fixed-length array of unboxed doubles, kept contiguous for the bulk
+// kernels in F64Kernels.
+class F64VectorValue : public Value {
+private:
+    std::vector<double> elements;
+public:
+    F64VectorValue(std::vector<double> elements) : Value(ValueType::F64VECTOR), elements{std::move(elements)} {}
+
+    std::vector<double>& getElements() {return elements;}
+    const std::vector<double>& getElements() const {return elements;}
+    std::string toString() const override;
+};
+
+// A fixed-length array of any values, for constant-time indexing.
+class VectorValue : public Value {
+private:
+    std::vector<ValuePtr> elements;
+public:
+    VectorValue(std::vector<ValuePtr> elements) : Value(ValueType::VECTOR), elements{std::move(elements)} {}
+
+    std::vector<ValuePtr>& getElements() {return elements;}
+    const std::vector<ValuePtr>& getElements() const {return elements;}
+    std::string toString() const override;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+};
+
+// A mutable map keyed by eq? or equal?, in one open-addressed array probed
+// linearly, so a lookup usually touches a single cache line. Each entry
+// keeps its key's hash, which spares most equality tests and makes growing
+// a matter of moving entries. Removed entries become tombstones until the
+// next rehash.
+class HashTableValue : public Value {
+public:
+    enum class Kind { EQ, EQUAL };
+private:
+    struct Entry {
+        ValuePtr key;
+        ValuePtr value;
+        size_t hash = 0;
+        bool removed = false;
+    };
+    Kind kind;
+    std::vector<Entry> entries;
+    size_t count = 0;
+    // Live entries and tombstones.
+    size_t used = 0;
+
+    size_t hash(const ValuePtr& key) const;
+    bool same(const ValuePtr& x, const ValuePtr& y) const;
+    // The index of key's entry, or of the empty entry that ends its probe.
+    size_t probe(const ValuePtr& key, size_t hash) const;
+    void rehash(size_t capacity);
+public:
+    HashTableValue(Kind kind) : Value(ValueType::HASH_TABLE), kind{kind}, entries(8) {}
+
+    Kind getKind() const {return kind;}
+    size_t size() const {return count;}
+    // The value stored under key, or null.
+    const ValuePtr* find(const ValuePtr& key) const;
+    void set(const ValuePtr& key, ValuePtr value);
+    // False when there was no such key.
+    bool remove(const ValuePtr& key);
+    std::vector<ValuePtr> keys() const;
+    std::string toString() const override;
+    void trace(Tracer& tracer) const override;
+    void clearReferences() override;
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "./vm.h"
+#include "./eval_env.h"
+#include "./builtin.h"
+#include "./jit.h"
+#include "./equality.h"
+#include <deque>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MINI_LISP_COMPUTED_GOTO
+#endif
+
+namespace {
+
+// One activation: the chunk being run, where in it, the frame its locals
+// live in, and where its part of the value stack starts. procedure keeps
+// the chunk of a called lambda alive.
+struct Frame {
+    const Chunk* chunk;
+    const uint32_t* ip;
+    EnvPtr env;
+    size_t base;
+    ValuePtr procedure;
+};
+
+// Builtins such as force and apply run procedures through a VM of their
+// own, so each nesting level of VM::run keeps one value stack and one frame
+// stack that hold their capacity from run to run. A deque, so handing out a
+// deeper level never moves the stacks of the levels still in use. Slots at
+// and above the stack pointer are always null, so pushing is a plain store.
+class Stacks {
+private:
+    struct Level {
+        std::vector<ValuePtr> values = std::vector<ValuePtr>(64);
+        std::vector<Frame> frames;
+    };
+    static inline std::deque<Level> levels;
+    static inline size_t depth = 0;
+    Level& level;
+    static Level& acquire() {
+        if (depth == levels.size())
+            levels.emplace_back();
+        return levels[depth++];
+    }
+public:
+    Stacks() : level{acquire()} {}
+    ~Stacks() {depth--;}
+    std::vector<ValuePtr>& values() {return level.values;}
+    std::vector<Frame>& frames() {return level.frames;}
+    // Doubles the value stack and returns the stack pointer moved with it.
+    ValuePtr* grow(ValuePtr* sp) {
+        size_t used = sp - level.values.data();
+        level.values.resize(level.values.size() * 2);
+        return level.values.data() + used;
+    }
+    // Drops whatever an exception left between the bottom and sp.
+    void unwind(ValuePtr* sp) {
+        for (auto value = level.values.data(); value < sp; ++value)
+            *value = nullptr;
+        level.frames.clear();
+    }
+};
+
+}
+
+// The stack pointer, instruction pointer, chunk and frame environment live
+// in locals, and the frame records are only written on a call. Handlers
+// only ever dispatch from outside their own block, so every local they
+// created has been destroyed before jumping to the next one.
+ValuePtr VM::run(const Chunk& entry, EnvPtr entryEnv){
+    Stats::count(Stats::EVAL);
+    Stacks stacks;
+    auto& frames = stacks.frames();
+    ValuePtr* bottom = stacks.values().data();
+    ValuePtr* limit = bottom + stacks.values().size();
+    ValuePtr* sp = bottom;
+    frames.push_back({&entry, entry.code.data(), std::move(entryEnv), 0, nullptr});
+    // Each frame after the first has a profiler frame; the first one gets
+    // its own only once it makes a tail call.
+    std::optional<Profiler::Mark> profiled;
+    if (Profiler::enabled())
+        profiled.emplace();
+    Frame* frame = &frames.back();
+    const Chunk* chunk = frame->chunk;
+    const uint32_t* ip = frame->ip;
+    EvalEnv* env = frame->env.get();
+    // The operands of the call being made; see doCall.
+    bool tailCall;
+    size_t argc;
+    ValuePtr* args;
+    const ValuePtr* callee;
+    ValuePtr* below;
+
+#define VM_PUSH(value)                                                         \
+    do {                                                                       \
+        if (sp == limit) [[unlikely]] {                                        \
+            sp = stacks.grow(sp);                                              \
+            bottom = stacks.values().data();                                   \
+            limit = bottom + stacks.values().size();                           \
+        }                                                                      \
+        new (sp++) ValuePtr(value);                                            \
+    } while (false)
+#define VM_POP() std::move(*--sp)
+// Clears every slot from to the stack pointer and makes it the new top.
+#define VM_DROP_TO(to)                                                         \
+    do {                                                                       \
+        ValuePtr* top = (to);                                                  \
+        while (sp > top)                                                       \
+            *--sp = nullptr;                                                   \
+    } while (false)
+
+    try {
+#ifdef MINI_LISP_COMPUTED_GOTO
+    static const void* const dispatch[] = {
+#define MINI_LISP_OPCODE_LABEL(name) &&op_##name,
+        MINI_LISP_OPCODES(MINI_LISP_OPCODE_LABEL)
+#undef MINI_LISP_OPCODE_LABEL
+    };
+#define VM_CASE(name) op_##name
+#define VM_NEXT() goto *dispatch[*ip++]
+    VM_NEXT();
+#else
+#define VM_CASE(name) case Op::name
+#define VM_NEXT() continue
+    while (true) switch (static_cast<Op>(*ip++)) {
+#endif
+
+    VM_CASE(CONST):
+        VM_PUSH(chunk->constants[*ip++]);
+        VM_NEXT();
+
+    VM_CASE(LOCAL):
+        VM_PUSH(env->ancestor(ip[0])->getSlot(ip[1]));
+        ip += 2;
+        VM_NEXT();
+
+    VM_CASE(GLOBAL):
+        VM_PUSH(env->lookupGlobal(chunk->names[ip[0]], ip[1], chunk->caches[ip[2]]));
+        ip += 3;
+        VM_NEXT();
+
+    VM_CASE(DEFINE_GLOBAL):
+        env->defineBinding(chunk->names[*ip++], VM_POP());
+        new (sp++) ValuePtr(ValuePtr::nil());
+        VM_NEXT();
+
+    VM_CASE(DEFINE_LOCAL):
+        env->setSlot(*ip++, VM_POP());
+        new (sp++) ValuePtr(ValuePtr::nil());
+        VM_NEXT();
+
+    VM_CASE(SET_LOCAL):
+        env->setSlot(*ip++, VM_POP());
+        VM_NEXT();
+
+    VM_CASE(POP):
+        *--sp = nullptr;
+        VM_NEXT();
+
+    VM_CASE(JUMP):
+        ip = chunk->code.data() + *ip;
+        VM_NEXT();
+
+    VM_CASE(JUMP_IF_FALSE):
+        if ((--sp)->isFalse())
+            ip = chunk->code.data() + *ip;
+        else
+            ip++;
+        *sp = nullptr;
+        VM_NEXT();
+
+    VM_CASE(JUMP_IF_TRUE):
+        if (!(--sp)->isFalse())
+            ip = chunk->code.data() + *ip;
+        else
+            ip++;
+        *sp = nullptr;
+        VM_NEXT();
+
+    VM_CASE(JUMP_IF_FALSE_KEEP):
+        if (sp[-1].isFalse())
+            ip = chunk->code.data() + *ip;
+        else {
+            *--sp = nullptr;
+            ip++;
+        }
+        VM_NEXT();
+
+    VM_CASE(JUMP_IF_TRUE_KEEP):
+        if (!sp[-1].isFalse())
+            ip = chunk->code.data() + *ip;
+        else {
+            *--sp = nullptr;
+            ip++;
+        }
+        VM_NEXT();
+
+    VM_CASE(CALL):
+        tailCall = false;
+        goto doCallStack;
+
+    VM_CASE(TAIL_CALL):
+        tailCall = true;
+    doCallStack:
+        argc = *ip++;
+        args = sp - argc;
+        callee = &args[-1];
+        below = args - 1;
+        goto doCall;
+
+    VM_CASE(CHECK_GLOBAL):
+        env->lookupGlobal(chunk->names[ip[0]], ip[1], chunk->caches[ip[2]]);
+        ip += 3;
+        VM_NEXT();
+
+    VM_CASE(CALL_GLOBAL):
+        tailCall = false;
+        goto doCallGlobal;
+
+    VM_CASE(TAIL_CALL_GLOBAL):
+        tailCall = true;
+    doCallGlobal:
+        callee = &env->lookupGlobal(chunk->names[ip[0]], ip[1], chunk->caches[ip[2]]);
+        argc = ip[3];
+        ip += 4;
+        args = sp - argc;
+        below = args;
+        goto doCall;
+
+    // Builtins only read their arguments during the call, and anything they
+    // run in turn gets a VM of its own, so they read them in place on the
+    // stack. A called lambda gets a new frame, or in tail position takes
+    // over the current one.
+    doCall: {
+        if (callee->getType() == ValueType::BUILTIN_PROC) {
+            auto builtin = static_cast<BuiltinProcValue*>(callee->get());
+            auto result = argc == 1 ? builtin->call(args[0], *env)
+                        : argc == 2 ? builtin->call(args[0], args[1], *env)
+                        : builtin->call(ValueSpan(args, argc), *env);
+            VM_DROP_TO(below);
+            new (sp++) ValuePtr(std::move(result));
+            if (tailCall)
+                goto doReturn;
+            VM_NEXT();
+        }
+        if (callee->getType() != ValueType::LAMBDA)
+            throw LispError("Invalid procedure type");
+        ValuePtr procedure = *callee;
+        auto lambda = static_cast<LambdaValue*>(procedure.get());
+        if (Jit::enabled())
+            if (auto result = Jit::call(*lambda, ValueSpan(args, argc))) {
+                VM_DROP_TO(below);
+                new (sp++) ValuePtr(std::move(result));
+                if (tailCall)
+                    goto doReturn;
+                VM_NEXT();
+            }
+        auto child = lambda->bind(Slots(std::make_move_iterator(args), std::make_move_iterator(sp)));
+        VM_DROP_TO(below);
+        const Chunk& code = lambda->getCode()->compiled();
+        env = child.get();
+        if (tailCall) {
+            VM_DROP_TO(bottom + frame->base);
+            frame->chunk = &code;
+            frame->env = std::move(child);
+            frame->procedure = std::move(procedure);
+            if (profiled) {
+                if (profiled->entered())
+                    Profiler::replace(lambda->getCode()->getName());
+                else
+                    Profiler::enter(lambda->getCode()->getName());
+            }
+        }
+        else {
+            frame->ip = ip;
+            frames.push_back({&code, code.code.data(), std::move(child), static_cast<size_t>(sp - bottom), std::move(procedure)});
+            frame = &frames.back();
+            if (profiled)
+                Profiler::enter(lambda->getCode()->getName());
+        }
+        chunk = &code;
+        ip = code.code.data();
+    }
+        VM_NEXT();
+
+    VM_CASE(RETURN):
+    doReturn: {
+        auto result = VM_POP();
+        VM_DROP_TO(bottom + frame->base);
+        frames.pop_back();
+        if (frames.empty())
+            return result;
+        if (profiled)
+            Profiler::leave();
+        frame = &frames.back();
+        chunk = frame->chunk;
+        ip = frame->ip;
+        env = frame->env.get();
+        new (sp++) ValuePtr(std::move(result));
+    }
+        VM_NEXT();
+
+    VM_CASE(CLOSURE):
+        VM_PUSH(makeValue<LambdaValue>(chunk->lambdas[*ip++], EnvPtr(env)));
+        VM_NEXT();
+
+    VM_CASE(PROMISE):
+        sp[-1] = makeValue<PromiseValue>(std::move(sp[-1]));
+        VM_NEXT();
+
+    VM_CASE(CONS): {
+        auto cdr = VM_POP();
+        sp[-1] = makeValue<PairValue>(std::move(sp[-1]), std::move(cdr));
+    }
+        VM_NEXT();
+
+    VM_CASE(ENTER): {
+        const auto& scope = chunk->scopes[ip[0]];
+        ValuePtr* inits = sp - ip[1];
+        ip += 2;
+        frame->env = env->createChild(scope, Slots(std::make_move_iterator(inits), std::make_move_iterator(sp)));
+        env = frame->env.get();
+        VM_DROP_TO(inits);
+    }
+        VM_NEXT();
+
+    VM_CASE(LEAVE):
+        frame->env = env->getParent();
+        env = frame->env.get();
+        VM_NEXT();
+
+    VM_CASE(CASE_MATCH): {
+        if (Equality::equal(sp[-1], chunk->constants[ip[0]]))
+            ip = chunk->code.data() + ip[1];
+        else
+            ip += 2;
+    }
+        VM_NEXT();
+
+#ifndef MINI_LISP_COMPUTED_GOTO
+    }
+#endif
+    }
+    catch (...) {
+        stacks.unwind(sp);
+        throw;
+    }
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_PUSH
+#undef VM_POP
+#undef VM_DROP_TO
+}
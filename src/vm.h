@@ -0,0 +1,14 @@
+#ifndef VM_H
+#define VM_H
+
+#include "./compiler.h"
+
+// Runs compiled chunks on an explicit value stack. Calls between lambdas
+// push a frame instead of recursing in C++, and tail calls replace the
+// current frame; builtins are called directly with the popped arguments.
+class VM {
+public:
+    static ValuePtr run(const Chunk& chunk, EnvPtr env);
+};
+
+#endif
@@ -0,0 +1,91 @@
+; Exact integer arithmetic past the fixnum range, at sizes that take each
+; of the algorithms in bigint.cpp: schoolbook and Karatsuba multiplication,
+; short and Burnikel-Ziegler division, and the divide-and-conquer decimal
+; conversion. Expected values were computed independently. Each check
+; compares a result with its expected value and exits with status 1 on the
+; first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+; quotient, remainder and modulo under every combination of signs.
+(check "fixnum quotient ++" (quotient 17 5) 3)
+(check "fixnum remainder ++" (remainder 17 5) 2)
+(check "fixnum modulo ++" (modulo 17 5) 2)
+(check "fixnum quotient +-" (quotient 17 (- 5)) -3)
+(check "fixnum remainder +-" (remainder 17 (- 5)) 2)
+(check "fixnum modulo +-" (modulo 17 (- 5)) -3)
+(check "fixnum quotient -+" (quotient (- 17) 5) -3)
+(check "fixnum remainder -+" (remainder (- 17) 5) -2)
+(check "fixnum modulo -+" (modulo (- 17) 5) 3)
+(check "fixnum quotient --" (quotient (- 17) (- 5)) 3)
+(check "fixnum remainder --" (remainder (- 17) (- 5)) -2)
+(check "fixnum modulo --" (modulo (- 17) (- 5)) -2)
+(check "big by fixnum quotient ++" (quotient (+ (expt 10 40) 123456789) 7) 1428571428571428571428571428571446208112)
+(check "big by fixnum remainder ++" (remainder (+ (expt 10 40) 123456789) 7) 5)
+(check "big by fixnum modulo ++" (modulo (+ (expt 10 40) 123456789) 7) 5)
+(check "big by fixnum quotient +-" (quotient (+ (expt 10 40) 123456789) (- 7)) -1428571428571428571428571428571446208112)
+(check "big by fixnum remainder +-" (remainder (+ (expt 10 40) 123456789) (- 7)) 5)
+(check "big by fixnum modulo +-" (modulo (+ (expt 10 40) 123456789) (- 7)) -2)
+(check "big by fixnum quotient -+" (quotient (- (+ (expt 10 40) 123456789)) 7) -1428571428571428571428571428571446208112)
+(check "big by fixnum remainder -+" (remainder (- (+ (expt 10 40) 123456789)) 7) -5)
+(check "big by fixnum modulo -+" (modulo (- (+ (expt 10 40) 123456789)) 7) 2)
+(check "big by fixnum quotient --" (quotient (- (+ (expt 10 40) 123456789)) (- 7)) 1428571428571428571428571428571446208112)
+(check "big by fixnum remainder --" (remainder (- (+ (expt 10 40) 123456789)) (- 7)) -5)
+(check "big by fixnum modulo --" (modulo (- (+ (expt 10 40) 123456789)) (- 7)) -5)
+(check "big by big quotient ++" (quotient (+ (expt 10 40) 123456789) (+ (expt 10 20) 9)) 99999999999999999991)
+(check "big by big remainder ++" (remainder (+ (expt 10 40) 123456789) (+ (expt 10 20) 9)) 123456870)
+(check "big by big modulo ++" (modulo (+ (expt 10 40) 123456789) (+ (expt 10 20) 9)) 123456870)
+(check "big by big quotient +-" (quotient (+ (expt 10 40) 123456789) (- (+ (expt 10 20) 9))) -99999999999999999991)
+(check "big by big remainder +-" (remainder (+ (expt 10 40) 123456789) (- (+ (expt 10 20) 9))) 123456870)
+(check "big by big modulo +-" (modulo (+ (expt 10 40) 123456789) (- (+ (expt 10 20) 9))) -99999999999876543139)
+(check "big by big quotient -+" (quotient (- (+ (expt 10 40) 123456789)) (+ (expt 10 20) 9)) -99999999999999999991)
+(check "big by big remainder -+" (remainder (- (+ (expt 10 40) 123456789)) (+ (expt 10 20) 9)) -123456870)
+(check "big by big modulo -+" (modulo (- (+ (expt 10 40) 123456789)) (+ (expt 10 20) 9)) 99999999999876543139)
+(check "big by big quotient --" (quotient (- (+ (expt 10 40) 123456789)) (- (+ (expt 10 20) 9))) 99999999999999999991)
+(check "big by big remainder --" (remainder (- (+ (expt 10 40) 123456789)) (- (+ (expt 10 20) 9))) -123456870)
+(check "big by big modulo --" (modulo (- (+ (expt 10 40) 123456789)) (- (+ (expt 10 20) 9))) -123456870)
+(check "exact quotient ++" (quotient (* (expt 10 30) (+ (expt 10 20) 9)) (+ (expt 10 20) 9)) 1000000000000000000000000000000)
+(check "exact remainder ++" (remainder (* (expt 10 30) (+ (expt 10 20) 9)) (+ (expt 10 20) 9)) 0)
+(check "exact modulo ++" (modulo (* (expt 10 30) (+ (expt 10 20) 9)) (+ (expt 10 20) 9)) 0)
+(check "exact quotient +-" (quotient (* (expt 10 30) (+ (expt 10 20) 9)) (- (+ (expt 10 20) 9))) -1000000000000000000000000000000)
+(check "exact remainder +-" (remainder (* (expt 10 30) (+ (expt 10 20) 9)) (- (+ (expt 10 20) 9))) 0)
+(check "exact modulo +-" (modulo (* (expt 10 30) (+ (expt 10 20) 9)) (- (+ (expt 10 20) 9))) 0)
+(check "exact quotient -+" (quotient (- (* (expt 10 30) (+ (expt 10 20) 9))) (+ (expt 10 20) 9)) -1000000000000000000000000000000)
+(check "exact remainder -+" (remainder (- (* (expt 10 30) (+ (expt 10 20) 9))) (+ (expt 10 20) 9)) 0)
+(check "exact modulo -+" (modulo (- (* (expt 10 30) (+ (expt 10 20) 9))) (+ (expt 10 20) 9)) 0)
+(check "exact quotient --" (quotient (- (* (expt 10 30) (+ (expt 10 20) 9))) (- (+ (expt 10 20) 9))) 1000000000000000000000000000000)
+(check "exact remainder --" (remainder (- (* (expt 10 30) (+ (expt 10 20) 9))) (- (+ (expt 10 20) 9))) 0)
+(check "exact modulo --" (modulo (- (* (expt 10 30) (+ (expt 10 20) 9))) (- (+ (expt 10 20) 9))) 0)
+
+; Products of operands over 32 limbs, balanced and unbalanced.
+(define x (- (expt 3 2000) 1))
+(define y (+ (expt 7 1500) 12345))
+(define z (+ (expt 2 1100) 1))
+(check "karatsuba" (* x y) 77547796276317754161012692094900348967371092709905356923186163300932882256251125949316349958691099107367108374085844584202558152133333711256944689186715664994002176109010200307269664025883709044528370540160459974162414298105372686279983835426143075795316221867342994155798943530221846295118641824796804291731841852500103474164280815437032617690014997064942458498159323412384542936727796455534590311790898062113547958311213988280295010193620209943815674460634485440935186434405135564526817557486801287326153047693075908790160159261541408530622701109613299832443045774946304048828544840966001744587410342583557279386642984317289275776963073831933613532055950324453797676004452979596849910110665110237800607463674077932825161632145126898133754524286398083924989159569594837436005935940014187606107418043113898290175249598898314326148369028236392042994248241027012935509908662758101333518015177221147635956535830434442128306839629560591495816111175089265606864671801022116207193502801108755984904172653389944161206760036109271778736426231502087840351291559127839283303376420462406625553013398316388572877151507530693780986896936334426117939039303869219586516347681360663983862316411983665837263198530317406968636935571417729983255087247402689369959666011925727295240302108259262092097291656121183230979104278730761917533073338758557556815383969139084246902211057410327830523397211065899398010440511680689043866733565967072510140682006846971534454626597609062739631881142312115810404009401332738482987213216138721759915047506509686720833983141734360645627452050255381995063370675696630948768708438836566482121371122654637762315730771721566010505150163262818421869871486610760733196235954062248657371388962774991380357285107398547813414673814964464864025925905762193839625187002175366717900509916798995936813141563281673330668857091909215733815636947333975591889559812300131224994491966949505774310146332716138784477387590737495271127435613496297627201386726505561671426072128321662780835194777633581655351823375985388273127122461078254965074344289721725966677723045222210544839818131452110305327217652571216810691836545129070298727880403855078882122633939856647484513653036484753387133846949700041112239024682911986243492240000)
+(check "karatsuba negative" (* (- x) y) -77547796276317754161012692094900348967371092709905356923186163300932882256251125949316349958691099107367108374085844584202558152133333711256944689186715664994002176109010200307269664025883709044528370540160459974162414298105372686279983835426143075795316221867342994155798943530221846295118641824796804291731841852500103474164280815437032617690014997064942458498159323412384542936727796455534590311790898062113547958311213988280295010193620209943815674460634485440935186434405135564526817557486801287326153047693075908790160159261541408530622701109613299832443045774946304048828544840966001744587410342583557279386642984317289275776963073831933613532055950324453797676004452979596849910110665110237800607463674077932825161632145126898133754524286398083924989159569594837436005935940014187606107418043113898290175249598898314326148369028236392042994248241027012935509908662758101333518015177221147635956535830434442128306839629560591495816111175089265606864671801022116207193502801108755984904172653389944161206760036109271778736426231502087840351291559127839283303376420462406625553013398316388572877151507530693780986896936334426117939039303869219586516347681360663983862316411983665837263198530317406968636935571417729983255087247402689369959666011925727295240302108259262092097291656121183230979104278730761917533073338758557556815383969139084246902211057410327830523397211065899398010440511680689043866733565967072510140682006846971534454626597609062739631881142312115810404009401332738482987213216138721759915047506509686720833983141734360645627452050255381995063370675696630948768708438836566482121371122654637762315730771721566010505150163262818421869871486610760733196235954062248657371388962774991380357285107398547813414673814964464864025925905762193839625187002175366717900509916798995936813141563281673330668857091909215733815636947333975591889559812300131224994491966949505774310146332716138784477387590737495271127435613496297627201386726505561671426072128321662780835194777633581655351823375985388273127122461078254965074344289721725966677723045222210544839818131452110305327217652571216810691836545129070298727880403855078882122633939856647484513653036484753387133846949700041112239024682911986243492240000)
+(check "karatsuba square" (* x x) 3055053912598508947549312393399320015114587255945938203336157885612484041009431069888461714759195551268559435567253681739042432883596095251201386787275483230684744081267827125833440603460902730356711375071354094223050737888829629366162631931903817637647689717474539783041913377052664360754530594685529992367990825283283974149969505378127988908031568501855509144132763267482753608051191973699171623938029652959112481486845481337238191540360720284661730596472758771447004611908440098952257078699946478448550527286513833176626948662169918947393179985715374284032316042361252971237912148029845209003214291118712054140346782303768450257172267231798011098225054231267262248662475182151309040596831972573353215246137318080262085035181877250579293515354614855964555777830248629948465567786086862810753702795567587162067253726096003964964500688100664251086317265876947315204732848217800469886468299762701072555744747779591654828652607439719426907428525310220609955309819721617576262789675851366073061570468522797612196031888311845314307547563924731393779446794157783434571771553331955397352876394094051941886918290151696520463861395769764038244870459011607068038002296891122817221202978270206226420430308203393990719198699202489559335671857628038705901154764764301800602765737907469529783037992012417680219172953899219847371527106620463846565700941491795981628461762356211913130336305338929864626781025079817236303994824784993888715598971678661436437912619599238774674590935940480925183409560092329805146549011261703338187952367215862409037053747158227565640764969231205605287751014534535318103818582497293893969055481689349016892684335741520664541368967892666259751945544675393054146946259609628160288555135137849326127466529912979858745487418172096515256544007002059240737087937218733405118394722922927624470616016858614364527451498020212690181693132494855681465723237387966460343570887099694368068659716993600000000)
+(check "karatsuba unbalanced" (* z (* x y)) 1053330576131438467921801517691981255571515737452792278615394038351861269436546706288991681156353154312576276032731316336681623397392976911326936623852634639160228332826525695666506038647550072117888355468221642964903980258672288460984248631521524802662190752153475843284609138038976262361599533935416076754819823527397945134681615603432075839478003729347268675066664346940161131813266388529591135669019554803510931431885873128447132613122905510951131918311992268697474495418751541078668570564865649537859088481894689355462102991040141871398772816093356548737861718030740550954655155647788341355668015823564518585940468661602408849875387268516055821973493476977155302053742969129707254289125677026088908091706567090164322852118625642797447052462451090794328504918958475158068058311152670880108368270152395388182697602824751194101096939313722854943357408193549762957685873233988721128270213459394037409640167004738872607576128946694496037577585301607416561130830091924995971981726142218281706634926458157041470607059745584224479859864299755902445359864693763791720324666667420012764509601885531326903896668711859387687709009512790442410573076212689535674438159511348441490592974835519228623444724126419695438802181418288718756512341238719589309466753593207016630883785340819488631536922343190909886756388039121745434810832764080619588586884570782910794155175901648434982702011764137117677603458414008429810074792501328516879972022482104475308463518486802321467291548722846590355797592920923259056502846562867807517291045506722172403161966775618119073222180547578728526002439712846214341971069535838678263262342621097568493877944478662381112650864699813193712254987197812311337951568219743291642911987682969087501061170259432982058051813591100780352043822866975183009037379063203379801923085795287941002427547470054791139284485517042092466901266507888980178925167125321961028146391855367082519421888085431854503240377011879182818646245560084250062939789853474217956936217440707359705632087156025865601027982810274619754372070311974450778951858893411459412387907363242482771568327514739547748048653618074213712996037302865607898417731279955357378139000299429629205611937528220585860480819747698800387989767760411497667472322540688868655689351516805763940647180164520332052907507996488345521504660604790249869346618240310352672518249600626750784884093582522511936943936989755709288866671444772203316334003197908905457616584835920669912383049393876204330972602036768203042918454484035024377674548303457323549181503826510214148525521102432498023696576174480000)
+
+; Divisors over 40 limbs.
+(define n (+ (expt 3 5000) 17))
+(define d (+ (expt 7 900) 1))
+(check "burnikel-ziegler quotient ++" (quotient n d) 104240763937496341797806442848778241685118664420209601634524077134792433870741957674015204098712644429577857595991755626136509105988201394266263776639419386729002240079499570510640017214555022700624625189380907441096417446759482252745495029895030667023516643884155751166471376956880769576750396579663286409519412121638872471408288075480681805730849423789109483818708651194931576215722705733574472960384197346596162416185142619252814010896971030683415032027114391824441299941370124846352832396682212634274525781800781323151879430062290888598368945722524276255799232647370935532613526397455790258506633795172942341380591049087915299598412664112750720474562134213032219024721734240907266812664141939026398892348930078229339694642320714251902632818197658623087818628864102918632997157943047388534375260922654513180078760582135748106980107331684542162555931126916842253050082751046262473013724918749430773034042550020525169238777851930854951249487217622406540026287447729563909806722662517535709013831792376906978388813456525883703533863597275942234347181535316429886572086328908469230496916639184143572208868450456696438502906992508914465058018597369763005721331011625533099674707997739746570330526712248612773160523154597533739617521241378953064607575289753836701831011085131154749839405438352805944633932562623039349078294831564672654146771367772801867530765688397511279217748068928364729744637121668470265576103309575205292081872165230855962278639225076341822102340253510815668553134173747270151717442417443815194047606203554105274543241912187865481856649552022391832283459951888927832246133845315340840862095237112904078660850)
+(check "burnikel-ziegler remainder ++" (remainder n d) 26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "burnikel-ziegler modulo ++" (modulo n d) 26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "burnikel-ziegler quotient +-" (quotient n (- d)) -104240763937496341797806442848778241685118664420209601634524077134792433870741957674015204098712644429577857595991755626136509105988201394266263776639419386729002240079499570510640017214555022700624625189380907441096417446759482252745495029895030667023516643884155751166471376956880769576750396579663286409519412121638872471408288075480681805730849423789109483818708651194931576215722705733574472960384197346596162416185142619252814010896971030683415032027114391824441299941370124846352832396682212634274525781800781323151879430062290888598368945722524276255799232647370935532613526397455790258506633795172942341380591049087915299598412664112750720474562134213032219024721734240907266812664141939026398892348930078229339694642320714251902632818197658623087818628864102918632997157943047388534375260922654513180078760582135748106980107331684542162555931126916842253050082751046262473013724918749430773034042550020525169238777851930854951249487217622406540026287447729563909806722662517535709013831792376906978388813456525883703533863597275942234347181535316429886572086328908469230496916639184143572208868450456696438502906992508914465058018597369763005721331011625533099674707997739746570330526712248612773160523154597533739617521241378953064607575289753836701831011085131154749839405438352805944633932562623039349078294831564672654146771367772801867530765688397511279217748068928364729744637121668470265576103309575205292081872165230855962278639225076341822102340253510815668553134173747270151717442417443815194047606203554105274543241912187865481856649552022391832283459951888927832246133845315340840862095237112904078660850)
+(check "burnikel-ziegler remainder +-" (remainder n (- d)) 26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "burnikel-ziegler modulo +-" (modulo n (- d)) -11756883456279796639876935232592801871470076337088386537475281617607847814562407056159168213304543956976089703892274477138500522290018128646807126471317687854204116211719505618794663968241109267721373580089933589497518403932366740285342383689200077858200046985865599011182779161890821392832429372770757194036103452086158527442117294831277316878571774513415521737131072291510015116286354083618258045678812130052503291046451723991699326826898884818020502488174519637242806339774291045427710088204888530081821477592161045018347272084804717400914766063416229774664885123390467670518639458405356217388475894645114121880018779760865379880771027146398193707600785611387279779326564169321357002882886783628243150796841236828402406960053760864766109066973818087892761684)
+(check "burnikel-ziegler quotient -+" (quotient (- n) d) -104240763937496341797806442848778241685118664420209601634524077134792433870741957674015204098712644429577857595991755626136509105988201394266263776639419386729002240079499570510640017214555022700624625189380907441096417446759482252745495029895030667023516643884155751166471376956880769576750396579663286409519412121638872471408288075480681805730849423789109483818708651194931576215722705733574472960384197346596162416185142619252814010896971030683415032027114391824441299941370124846352832396682212634274525781800781323151879430062290888598368945722524276255799232647370935532613526397455790258506633795172942341380591049087915299598412664112750720474562134213032219024721734240907266812664141939026398892348930078229339694642320714251902632818197658623087818628864102918632997157943047388534375260922654513180078760582135748106980107331684542162555931126916842253050082751046262473013724918749430773034042550020525169238777851930854951249487217622406540026287447729563909806722662517535709013831792376906978388813456525883703533863597275942234347181535316429886572086328908469230496916639184143572208868450456696438502906992508914465058018597369763005721331011625533099674707997739746570330526712248612773160523154597533739617521241378953064607575289753836701831011085131154749839405438352805944633932562623039349078294831564672654146771367772801867530765688397511279217748068928364729744637121668470265576103309575205292081872165230855962278639225076341822102340253510815668553134173747270151717442417443815194047606203554105274543241912187865481856649552022391832283459951888927832246133845315340840862095237112904078660850)
+(check "burnikel-ziegler remainder -+" (remainder (- n) d) -26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "burnikel-ziegler modulo -+" (modulo (- n) d) 11756883456279796639876935232592801871470076337088386537475281617607847814562407056159168213304543956976089703892274477138500522290018128646807126471317687854204116211719505618794663968241109267721373580089933589497518403932366740285342383689200077858200046985865599011182779161890821392832429372770757194036103452086158527442117294831277316878571774513415521737131072291510015116286354083618258045678812130052503291046451723991699326826898884818020502488174519637242806339774291045427710088204888530081821477592161045018347272084804717400914766063416229774664885123390467670518639458405356217388475894645114121880018779760865379880771027146398193707600785611387279779326564169321357002882886783628243150796841236828402406960053760864766109066973818087892761684)
+(check "burnikel-ziegler quotient --" (quotient (- n) (- d)) 104240763937496341797806442848778241685118664420209601634524077134792433870741957674015204098712644429577857595991755626136509105988201394266263776639419386729002240079499570510640017214555022700624625189380907441096417446759482252745495029895030667023516643884155751166471376956880769576750396579663286409519412121638872471408288075480681805730849423789109483818708651194931576215722705733574472960384197346596162416185142619252814010896971030683415032027114391824441299941370124846352832396682212634274525781800781323151879430062290888598368945722524276255799232647370935532613526397455790258506633795172942341380591049087915299598412664112750720474562134213032219024721734240907266812664141939026398892348930078229339694642320714251902632818197658623087818628864102918632997157943047388534375260922654513180078760582135748106980107331684542162555931126916842253050082751046262473013724918749430773034042550020525169238777851930854951249487217622406540026287447729563909806722662517535709013831792376906978388813456525883703533863597275942234347181535316429886572086328908469230496916639184143572208868450456696438502906992508914465058018597369763005721331011625533099674707997739746570330526712248612773160523154597533739617521241378953064607575289753836701831011085131154749839405438352805944633932562623039349078294831564672654146771367772801867530765688397511279217748068928364729744637121668470265576103309575205292081872165230855962278639225076341822102340253510815668553134173747270151717442417443815194047606203554105274543241912187865481856649552022391832283459951888927832246133845315340840862095237112904078660850)
+(check "burnikel-ziegler remainder --" (remainder (- n) (- d)) -26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "burnikel-ziegler modulo --" (modulo (- n) (- d)) -26989931870294105305973666053536688515460980412769382020004066155087981790395204318318288674913121879402939399230082679158412788175401971930266431886908590104921554747241796885366969952022895311988846099590071531239674134391358675362743479545760088935634202252172368318596080318633554645097803949276803610392017589139264829925344259128219530802661308712144821947455086741419882824916080514181680589436467607306631804547446893438700485633437553592856726726087677581281744538946054000407621325695872928430078518694282728151393627155949089976793045365522548990260743116479506904425591742442268776592545876275960176561055169284675457466314260691055682538043219326972371052397898120337865028063093452542235526909291388059955370936805246343755157725999215734059778318)
+(check "all-ones limbs" (quotient (- (expt 2 3840) 1) (- (expt 2 1600) 1)) 202857134892728222244455403780239889732096631820631910664811230146099062855146473052224130364722436309490715726098786354848816111231680845226448353724275453289580670277217961928830076407081110482465587228976018799780290606465698196232041597111159153869078635638735543524306207918549051538549551164404570819071864354820267713799742030482847271235462527395385087504985278985294294036715279423317412236088134437741573828351126982707531493745059920401045295323758119680060244068380066852077740007205944505107314857301869723523968704484639789833634499268072457423929417029862771223792861516607948556425604480608435090554894854547211287353546520750654620348387993749457086869143552)
+(check "all-ones limbs remainder" (remainder (- (expt 2 3840) 1) (- (expt 2 1600) 1)) 4562440617622195218641171605700291324893228507248559930579192517899275167208677386505912811317371399778642309573594407310688704721375437998252661319722214188251994674360264950082874192246603775)
+(check "product divided back" (quotient (* x y) y) 1747871251722651609659974619164660570529062487435188517811888011810686266227275489291486469864681111075608950696145276588771368435875508647514414202093638481872912380089977179381529628478320523519319142681504424059410890214500500647813935818925701905402605484098137956979368551025825239411318643997916523677044769662628646406540335627975329619264245079750470862462474091105444437355302146151475348090755330153269067933091699479889089824650841795567478606396975664557143737657027080403239977757865296846740093712377915770536094223688049108023244139183027962484411078464439516845227961935221269814753416782576455507316073751985374046064592546796043150737808314501684679758056905948759246368644416151863138085276603595816410945157599742077617618911601185155602080771746785959359879490191933389965271275403127925432247963269675912646103156343954375442792688936047041533537523137941310690833949767764290081333900380310406154723157882112449991673819054110440000)
+
+; Decimal conversion of values thousands of digits long, including one
+; whose digits are mostly zeros.
+(check "decimal" (number->string (expt 3 10000)) "16313501853426258743032567291811547168121324535825379939348203261918257308143190787480155630847848309673252045223235795433405582999177203852381479145368112501453192355166224391025423628843556686559659645012014177448275529990373274425446425751235537341867387607813619937225616872862016504805593174059909520461668500663118926911571773452255850626968526251879139867085080472539640933730243410152186914328917354576854457274195562218013337745628502470673059426999114202540773175988199842487276183685299388927825296786440252999444785694183675323521704432195785806270123388382931770198990841300861506996108944782065015163410344894945809337689156807686673462563038164792190665340124344133980763205594364754963451564072340502606377790585114123814919001637177034457385019939060232925194471114235892978565322415628344142184842892083466227875760501276009801530703037525839157893875741192497705300469691062454369926795975456340236777734354667139072601574969834312769653557184396147587071260443947944862235744459711204473062937764153770030210332183635531818173456618022745975055313212598514429587545547296534609597194836036546870491771927625214352957503454948403635822345728774885175809500158451837389413798095329711993092101417428406774326126450005467888736546254948658602484494535938888656542746977424368385335496083164921318601934977025095780370104307980276356857350349205866078371806065542393536101673402017980951598946980664330391505845803674248348878071010412918667335823849899623486215050304052577789848512410263834811719236949311423411823585316405085306164936671137456985394285677324771775046050970865520893596151687017153855755197348199659070192954771308347627111052471134476325986362838585959552209645382089055182871854866744633737533217524880118401787595094060855717010144087136495532418544241489437080074716158404895914136451802032446707961058757633345691696743293869623745410870051851590672859347061212573446572045088465460616826082579731686004585218284333452396157730036306379421822435818001505905203918209206969662326706952623512427380240468784114535101496733983401240219840048956733689309620321613793757156727562461651933397540266795963865921590913322060572673349849253303397874242381960775337182730037783698708748781738419747698880321601186310506332869704931303076839444790968339306301273371014087248060946851793697973114432706759288546077622831002526800554849696867710280945946603669593797354642136622231192695027321229511912952940320879763123151760555959496961163141455688278842949587288399100273691880018774147568892650186152065335219113072582417699616901995530249937735219099786758954892534365835235843156112799728164123461219817343904782402517111603206575330527850752564642995318064985900815557979945885931124351303252811255254295797082281946658798705979077492469849644183166585950844953164726896146168297808178398470451561320526180542310840744843107469368959707726836608471817060598771730170755446473440774031371227437651048421606224757527085958515947273151027400662948161111284777828103531499488913672800783167888051177155427285103861736658069404797695900758820465238673970882660162285107599221418743657006872537842677883708807515850397691812433880561772652364847297019508025848964833883225165668986935081274596293983121864046277268590401580209059988500511262470167150495261908136688693861324081559046336288963037090312033522400722360882494928182809075406914319957044927504420797278117837677431446979085756432990753582588102440240611039084516401089948868433353748444104639734074519165067632941419347985624435567342072815910754484123812917487312938280670403228188813003978384081332242484646571417574404852962675165616101527367425654869508712001788393846171780457455963045764943565964887518396481296159902471996735508854292964536796779404377230965723361625182030798297734785854606060323419091646711138678490928840107449923456834763763114226000770316931243666699425694828181155048843161380832067845480569758457751090640996007242018255400627276908188082601795520167054701327802366989747082835481105543878446889896230696091881643547476154998574015907396059478684978574180486798918438643164618541351689258379042326487669479733384712996754251703808037828636599654447727795924596382283226723503386540591321268603222892807562509801015765174359627788357881606366119032951829868274617539946921221330284257027058653162292482686679275266764009881985590648534544939224296689791195355783205968492422636277656735338488299104238060289209390654467316291591219712866052661347026855261289381236881063068219249064767086495184176816629077103667131505064964190910450196502178972477361881300608688593782509793781457170396897496908861893034634895715117114601514654381347139092345833472226493656930996045016355808162984965203661519182202145414866559662218796964329217241498105206552200001")
+(check "decimal negative" (number->string (- (expt 2 20000))) "-398027684033796659235430720619120245370477278049242593871342686565238635974930057042676009749975595510836461137504912702831400376935319143621753470415827025981215282426893498224826615977707595539466961019588699726772279731941315198182787264034852821200164566127930390710398182979935327718016873784821349516406114982916691867361875370024545872140793827277482562824192439237801588697814168520338650090909697535966525032757049430286459482977357373598020450589927318365663076719136934132593126761906696003770385305284570331119691001526584347722012386381881779425549210851696458253943578557699072154639655630793883941961378971846841113804188730258903839103669626086974468150655710480841592465655211805257863007811676888839555017536731758113448656752514158601444051645154665514388431619042396106716755762338728183461369854648923972904427556158821823778729193111453445844216979095435045778144571378954652122396061615147642540250745857228893999875491625014946013839340891326060933901036249999238637827577774666644809734033861619420363936465178730919233673114244563915058438996625834112132967998495576249320462871747777012165543887156255858358784852335060574881876552025685704823768078710818951860741379429242110855644973977420413810373514584504006896392675854997866870818564207239083874324953871276375716101506575153205747363963740749867514682619756775534507006871485887812402927738227576635284174246988540785975240020481266853076127172228024330561550120182008777598230542033702463408316671120886169260934006805799864598636311179787776738608992346063063099659648279663878174074787179237169752957046404584525301384153358344055908219695854852185210739761460551596658211013159915409566145426809737550417578228465835830890294497535463112081537672664056891624345779311524560019984315456142126282898486728345004767873499752683471409587367450593302392307908004590644754012537113320493601682133709318222647489080531644015321391157387178232154126828007760313716872242209614200967522180475716199973689467714010404673961454146466045855232217196687665143147612199151921277432309700460321430381533385245877431330533479476152339364503436322919665631042328740463612565842560411947020174006507893396276103834436233140915025391014386119201176462659556388343058600326710618903683746516577021214276933289179021059956925949717956040857979165914170970056212869933593589268626151996676594370800885093048230687152803213254735594741799076039453057272319884322341883241036382617598401889439130301876975498681736174215711287053447013711596004574803562701388246822510391522419061320663740921321754344166744899588160649291823535983386025904942040724581017615968429577015808090360968544059204594200069304612417366398776831532265596224715750301792207725607932534543693758772262010387360435567635232718343420679693057360004073679493008945813961012439574397373178636054628207647520675194420244271036343729318858430871461978866964772362057290577326080664463129657590249859748544101333842092713653096656066266827446079145590196644643417403723220085696202719321533233027169599734928971588850348415000070034027025298183104148343980297663148971586607903771717880683175436445585810610546882073571556162324659351310326560804448974229349743425637164834242799991427145050899469511954834774847172360693568437689147399455672090773686782511054291185172381917008889957645311339950993044779783607140593766508017935992581357858306525303783231752425242008347844867988333025417249944092118578113687403158162707075154006053416374075765162668533127078605316562826337193606242535290683224423660462222408680300498714149607265550441220738075941633988435051594487256802874182264814425923111193188280632013127802897889605338783089532740877202304122498193625454768343775535498872821099981620497070810489137457106892573248498734243717184800822956334469415666818858073218653977954309023182851723246522042792401461382001601920501284439325214084210736400630884929942272982943613708123011355260915545831043160243523599372006226150289664982113944898886610710824955096724626895416484521819026132177640598691658035986285376355033719094568083122219345722063613609779158338084375331431276527548482566210071347744541292871876134764249704859840950276227627328897424208932988115108907187647698491814375639614313178092528678007370045871748218421786396197284213209022623762734630836006864192414605237248983289006905268988475197599781524158913583701325199090352274252608342971303907669363045656232183978755853064004010895030834921988601355201181158877254807798058635127708445592064519563115094749276606697559529332807221414021024905241788974917755034700510432039890197393691722911126889174394312127254793141624975830429097997705531781908242083922068769027355129212617244130640289994777413026624013157329948333586377955103195844817163822484232700763859290253400376515701986753596890075818544485475785780031843579065754095099970940504640212850809997051128976563880886392410766321449987529690463262182894272302749154535447233331028841215215533602398281107050696017507827602761547816324743297938177204183765821117818869959795031848201322436053103778993541384779857262311465895754085538371969040922420936915076653500310175006188572019017358300979056992161958286882575984331858170857303361269891312794369244896540323192451678830668180455059289743580640736076233561935888109525845803125912388965524166819855977061399043499229843517930169118036812460794615667808961600389778306540324849286501515292799391304510997298128228258006156017389878086272789993321416349205921635696963703558971391123174877353757536774013315034956942784403824181551741629180658414081905650333672638983416786388095026169496605199749691595798835947189777822765198767949699778106683862989103096006505865271003566346191382406011673958404009194852110016915222433459641787170917872140367871023596464051647947388580570774462304347896201676197195521428782313608583714399238092208362933211302942806480175589402387976531080436906856834377344137698180789562645974374155400497754843905032231188252125802180353577510519869570675234892321663406309376")
+(check "decimal zeros" (number->string (+ (expt 10 5000) 1)) "100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001")
@@ -0,0 +1,75 @@
+; Procedures hot enough for --jit to compile, called in each way that makes
+; the native code bail out to the interpreter. Without --jit every call is
+; interpreted and the results are the same. Each check compares a result
+; with its expected value and exits with status 1 on the first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+; Calls thunk often enough for the procedure it calls to be compiled.
+(define (warm thunk) (do ((i 0 (+ i 1))) ((= i 20) (thunk)) (thunk)))
+
+; Overflowing int64, in one operation and part way through a loop.
+(define (mul a b) (* a b))
+(define (add a b) (+ a b))
+(define (sub a b) (- a b))
+(define (power-of-two n) (do ((i 0 (+ i 1)) (acc 1 (* acc 2))) ((= i n) acc)))
+(define (factorial n acc) (if (= n 0) acc (factorial (- n 1) (* acc n))))
+(check "mul warm" (warm (lambda () (mul 6 7))) 42)
+(check "add warm" (warm (lambda () (add 6 7))) 13)
+(check "sub warm" (warm (lambda () (sub 6 7))) -1)
+(check "power warm" (warm (lambda () (power-of-two 10))) 1024)
+(check "factorial warm" (warm (lambda () (factorial 5 1))) 120)
+(check "mul past fixnums" (mul 4294967296 65536) 281474976710656)
+(check "mul overflow" (mul 4611686018427387904 4) 18446744073709551616)
+(check "add overflow" (add 9223372036854775807 1) 9223372036854775808)
+(check "sub overflow" (sub -9223372036854775807 2) -9223372036854775809)
+(check "loop overflow" (power-of-two 70) 1180591620717411303424)
+(check "tail call overflow" (factorial 25 1) 15511210043330985984000000)
+(check "after overflow" (factorial 10 1) 3628800)
+
+; The one quotient idiv can't represent.
+(define (div a b) (quotient a b))
+(define (rem a b) (remainder a b))
+(check "div warm" (warm (lambda () (div 7 2))) 3)
+(check "rem warm" (warm (lambda () (rem -7 2))) -1)
+(check "div overflow" (div -9223372036854775808 -1) 9223372036854775808)
+(check "rem by -1" (rem -9223372036854775808 -1) 0)
+
+; Recursion deeper than the native stack limit.
+(define (deep n a b c d) (let ((x (+ a b)) (y (+ c d))) (if (= n 0) (- x y) (+ 1 (deep (- n 1) a b c d)))))
+(check "deep warm" (warm (lambda () (deep 5 1 2 3 4))) 1)
+(check "deep recursion" (deep 8000 1 2 3 4) 7996)
+(check "shallow after deep" (deep 10 1 2 3 4) 6)
+
+; Arguments that are not integers in the int64 range.
+(define (twice x) (+ x x))
+(define (positive? x) (> x 0))
+(check "twice warm" (warm (lambda () (twice 21))) 42)
+(check "positive warm" (warm (lambda () (positive? 3))) #t)
+(check "double argument" (twice 2.5) 5.0)
+(check "bignum argument" (twice 100000000000000000000) 200000000000000000000)
+(check "double comparison" (positive? -0.5) #f)
+(check "bignum comparison" (positive? (- 0 100000000000000000000)) #f)
+(check "integer after double" (twice 4) 8)
+
+; Globals the native code was compiled against, redefined afterwards.
+(define (halve x) (quotient x 2))
+(define (count-to n acc) (if (= n 0) acc (count-to (- n 1) (+ acc 1))))
+(check "halve warm" (warm (lambda () (halve 10))) 5)
+(check "count warm" (warm (lambda () (count-to 10 0))) 10)
+(define builtin-quotient quotient)
+(define (quotient a b) 'redefined)
+(check "builtin redefined" (halve 10) 'redefined)
+(define quotient builtin-quotient)
+(check "builtin restored" (halve 10) 5)
+(define old-count-to count-to)
+(define (count-to n acc) 'replaced)
+(check "self redefined" (old-count-to 5 0) 'replaced)
+
+; Dividing by zero bails out too, and the interpreter reports the error,
+; which is why this comes last: ctest expects exactly that error followed
+; by the line after it.
+(define (div-by a b) (quotient a b))
+(check "div-by warm" (warm (lambda () (div-by 9 3))) 3)
+(div-by 1 0)
+(display "jit: done")
+(newline)
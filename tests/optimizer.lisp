@@ -0,0 +1,30 @@
+; Programs the optimizer must leave with their meaning intact. Each check
+; compares a result with its expected value and exits with status 1 on the
+; first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+; A let-bound constant is substituted into the unquoted parts of a quasiquote.
+(check "unquote" (let ((x 1)) `(a ,x)) '(a 1))
+(check "nested unquote" (let* ((a 2) (b (* a 3))) `(,a (,b c) . ,(+ a b))) '(2 (6 c) . 8))
+(check "folded unquote" `(a ,(+ 0 1)) '(a 1))
+
+; The binding itself survives for code that looks it up at run time.
+(define (f) (let ((n 3)) (list 'n (eval 'n))))
+(check "eval" (f) '(n 3))
+(check "eval at top level" (let ((n 4)) (eval '(+ n 1))) 5)
+
+; Calls in procedure bodies are not folded, so they see a later redefinition.
+(define (g) (* 60 60 24))
+(check "body before" (g) 86400)
+(define (* a b c) (quote redefined))
+(check "body after" (g) 'redefined)
+
+; Calls in code that may never run are not folded: each of these would
+; spend minutes computing a number that is thrown away, past the test's
+; timeout.
+(check "if branch" (if (> (car (list 1)) 0) 1 (expt 7 20000000)) 1)
+(check "cond clause" (cond ((> (car (list 1)) 0) 1) (else (expt 7 20000000))) 1)
+(check "case clause" (case (car (list 1)) ((1) 1) (else (expt 7 20000000))) 1)
+(check "and operand" (and (car (list #f)) (expt 7 20000000)) #f)
+(check "or operand" (or (car (list 1)) (expt 7 20000000)) 1)
+(check "do body" (do ((i 0 (+ i 1))) ((= i 0) i) (expt 7 20000000)) 0)
@@ -0,0 +1,62 @@
+; Persistent maps and sets: equality of maps built in different orders,
+; removal down to the empty map, structured keys and the pset builtins.
+; Each check compares a result with its expected value and exits with
+; status 1 on the first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+(define (add-up m from to) (if (> from to) m (add-up (pmap-assoc m from (* from from)) (+ from 1) to)))
+(define (add-down m from to) (if (< from to) m (add-down (pmap-assoc m from (* from from)) (- from 1) to)))
+(define (remove-all m from to) (if (> from to) m (remove-all (pmap-dissoc m from) (+ from 1) to)))
+
+(check "same keys, other order" (equal? (pmap 'a 1 'b 2 'c 3) (pmap 'c 3 'a 1 'b 2)) #t)
+(check "different value" (equal? (pmap 'a 1 'b 2) (pmap 'b 2 'a 3)) #f)
+(check "extra key" (equal? (pmap 'a 1) (pmap 'a 1 'b 2)) #f)
+(check "reassociated key" (equal? (pmap-assoc (pmap 'a 1 'b 2) 'a 5) (pmap 'b 2 'a 5)) #t)
+(define up (add-up (pmap) 1 500))
+(define down (add-down (pmap) 500 1))
+(check "ascending count" (pmap-count up) 500)
+(check "many keys, other order" (equal? up down) #t)
+(check "many keys lookup" (pmap-get down 321) 103041)
+(check "one key differs" (equal? up (pmap-assoc down 250 0)) #f)
+(check "map is not a set" (equal? (pmap 'a #t) (pset 'a)) #f)
+
+(define empty (remove-all up 1 500))
+(check "dissoc to empty" (pmap-count empty) 0)
+(check "empty keys" (pmap-keys empty) '())
+(check "empty equals new map" (equal? empty (pmap)) #t)
+(check "empty lookup" (pmap-get empty 1 'none) 'none)
+(check "original kept" (pmap-count up) 500)
+(check "dissoc missing key" (pmap-count (pmap-dissoc (pmap 'a 1) 'b)) 1)
+(check "dissoc last key" (equal? (pmap-dissoc (pmap 'a 1) 'a) (pmap)) #t)
+(check "half removed" (pmap-count (remove-all up 1 250)) 250)
+(check "half removed lookup" (pmap-get (remove-all up 1 250) 251) 63001)
+
+(define by-list (pmap '(1 2) 'pair (list 1 2 3) 'triple '() 'empty))
+(check "list key" (pmap-get by-list (list 1 2)) 'pair)
+(check "longer list key" (pmap-get by-list (cons 1 (list 2 3))) 'triple)
+(check "empty list key" (pmap-get by-list '()) 'empty)
+(check "missing list key" (pmap-get by-list (list 2 1) 'none) 'none)
+(check "list key replaced" (pmap-get (pmap-assoc by-list (list 1 2) 'new) '(1 2)) 'new)
+(check "list key replaced count" (pmap-count (pmap-assoc by-list (list 1 2) 'new)) 3)
+(check "list key removed" (pmap-count (pmap-dissoc by-list (list 1 2 3))) 2)
+(check "nested map key" (pmap-get (pmap (pmap 'a 1 'b 2) 'found) (pmap 'b 2 'a 1)) 'found)
+
+(define s (pset 1 2 3 'x "y" '(1 2)))
+(check "pset?" (pset? s) #t)
+(check "pmap is not pset" (pset? (pmap)) #f)
+(check "pset is not pmap" (pmap? s) #f)
+(check "pset count" (pset-count s) 6)
+(check "pset duplicate" (pset-count (pset 1 1 2)) 2)
+(check "pset contains" (pset-contains? s '(1 2)) #t)
+(check "pset contains string" (pset-contains? s "y") #t)
+(check "pset missing" (pset-contains? s 4) #f)
+(check "pset add" (pset-contains? (pset-add s 4) 4) #t)
+(check "pset add kept" (pset-contains? s 4) #f)
+(check "pset add existing" (pset-count (pset-add s 1)) 6)
+(check "pset remove" (pset-contains? (pset-remove s 'x) 'x) #f)
+(check "pset remove count" (pset-count (pset-remove s 'x)) 5)
+(check "pset remove missing" (pset-count (pset-remove s 'z)) 6)
+(check "pset->list" (length (pset->list s)) 6)
+(check "pset->list single" (pset->list (pset-remove (pset 'a 'b) 'a)) '(b))
+(check "pset other order" (equal? (pset 1 2 3) (pset 3 1 2)) #t)
+(check "pset removed to empty" (equal? (pset-remove (pset-remove (pset 1 2) 1) 2) (pset)) #t)
@@ -0,0 +1,15 @@
+; Promises forced from inside their own thunk. Each check compares a result
+; with its expected value and exits with status 1 on the first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+; The inner force finishes first and its value is the one kept, while the
+; outer call is still running the thunk it was given.
+(define flag (vector 0))
+(define p (delay (if (= (vector-ref flag 0) 0) (begin (vector-set! flag 0 1) (force p) 1) 2)))
+(check "reentrant force" (force p) 2)
+(check "forced again" (force p) 2)
+
+(define count (vector 0))
+(define q (delay (begin (vector-set! count 0 (+ (vector-ref count 0) 1)) (vector-ref count 0))))
+(check "first force" (force q) 1)
+(check "memoized" (force q) 1)
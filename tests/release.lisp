@@ -0,0 +1,17 @@
+; Dropping the last reference to a long chain of pairs frees it without
+; recursing once per pair. Each check compares a result with its expected
+; value and exits with status 1 on the first mismatch.
+(define (check name actual expected) (if (equal? actual expected) #t (begin (display "FAIL: ") (display name) (display " gave ") (display actual) (newline) (exit 1))))
+
+(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))
+(define (nest n acc) (if (= n 0) acc (nest (- n 1) (list acc))))
+
+(define l (build 1000000 '()))
+(check "long list" (length l) 1000000)
+(define l 0)
+(check "long list dropped" l 0)
+
+(define l (nest 1000000 '()))
+(check "nested list" (pair? (car l)) #t)
+(define l 0)
+(check "nested list dropped" l 0)